@@ -109,22 +109,30 @@ const Pwm_ChannelConfigType IoHwAb0_PwmChannels[] = {
         .TIMx             = TIM2,
         .channel          = 3,
         .classType        = PWM_VARIABLE_PERIOD,
-        .defaultPeriod    = 99,      /* 10 kHz */
+        .defaultPeriod    = 999,
+        .frequencyHz      = 1000,    /* 1 kHz, chung TIM2 với LED */
         .defaultDutyCycle = 0,       /* 0% ban đầu */
         .polarity         = PWM_HIGH,
         .idleState        = PWM_LOW,
-        .notificationEnable = 0
+        .notificationEnable = 0,
+        .ditherEnable     = 0,
+        .complementaryOutput = 0,
+        .phaseShift       = 0
     },
     /* Channel 4: PA3 - TIM2_CH4 - Điều khiển LED*/
     {
         .TIMx             = TIM2,
         .channel          = 4,
         .classType        = PWM_VARIABLE_PERIOD,
-        .defaultPeriod    = 999,     /* 1 kHz */
+        .defaultPeriod    = 999,
+        .frequencyHz      = 1000,    /* 1 kHz */
         .defaultDutyCycle = 0,       /* 0% ban đầu */
         .polarity         = PWM_HIGH,
         .idleState        = PWM_LOW,
-        .notificationEnable = 0
+        .notificationEnable = 0,
+        .ditherEnable     = 1,       /* Dithering cho mức sáng thấp mịn hơn */
+        .complementaryOutput = 0,
+        .phaseShift       = 0
     }
 };
 
@@ -145,7 +153,10 @@ const TemperatureSensorType LM35_Sensor = {
 const CoolingMotorType FanMotor = {
     .pwmChannelId = 0,       /* PWM channel index 0 trong IoHwAb0_PwmChannels */
     .pwmPeriod = 99,
-    .outputCompareValue = 0
+    .outputCompareValue = 0,
+    .minRunPercent = 30,     /* Quạt 12V thường đứng yên dưới ~30% */
+    .startPercent = 10,      /* Dừng ở 0% (<30°C), chỉ chạy lại khi lệnh >= 10% (35°C) */
+    .kickStartMs = 500       /* 0.5 s full duty để thắng ma sát tĩnh */
 };
 
 /* ========== Potentiometer & Bright of LED ========== */
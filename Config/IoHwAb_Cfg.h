@@ -15,6 +15,7 @@
 #include "Std_Types.h"
 
 #include "Port.h"
+#include "Dio.h"
 #include "MCAL/Adc/Adc.h"
 #include "Pwm.h"
 
@@ -53,6 +54,9 @@ typedef struct {
     Pwm_ChannelType pwmChannelId;
     Pwm_PeriodType  pwmPeriod;
     uint16          outputCompareValue;
+    uint8           minRunPercent;   /* Duty nhỏ nhất quạt còn quay được (%); lệnh 1..min được nâng lên min */
+    uint8           startPercent;    /* Lệnh nhỏ nhất để khởi động lại từ trạng thái dừng (%), tạo dải trễ bật/tắt */
+    uint16          kickStartMs;     /* Thời gian chạy 100% khi khởi động từ trạng thái dừng (ms, tối đa 30000), 0 = tắt */
 } CoolingMotorType;
 
 /* Struct biến trở */
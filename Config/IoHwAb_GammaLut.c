@@ -0,0 +1,43 @@
+/**********************************************************
+ * @file    IoHwAb_GammaLut.c
+ * @brief   Bảng tra gamma cho độ sáng LED (file sinh tự động)
+ * @details Sinh bởi Config/gen_gamma_lut.py (CIE 1931 lightness, 256 phần tử).
+ *          Không sửa tay, chạy lại: make gamma
+ **********************************************************/
+
+#include "IoHwAb_GammaLut.h"
+
+const uint16_t IoHwAb_LedGammaLut[IOHWAB_LED_GAMMA_LUT_SIZE] = {
+    0x0000, 0x000E, 0x001C, 0x002B, 0x0039, 0x0047, 0x0055, 0x0064,
+    0x0072, 0x0080, 0x008E, 0x009C, 0x00AB, 0x00B9, 0x00C7, 0x00D5,
+    0x00E4, 0x00F2, 0x0100, 0x010E, 0x011D, 0x012B, 0x013A, 0x0149,
+    0x0158, 0x0169, 0x0179, 0x018B, 0x019C, 0x01AF, 0x01C1, 0x01D5,
+    0x01E8, 0x01FD, 0x0212, 0x0227, 0x023E, 0x0254, 0x026B, 0x0283,
+    0x029C, 0x02B5, 0x02CF, 0x02E9, 0x0304, 0x0320, 0x033C, 0x0359,
+    0x0377, 0x0395, 0x03B4, 0x03D3, 0x03F4, 0x0415, 0x0437, 0x0459,
+    0x047C, 0x04A0, 0x04C5, 0x04EA, 0x0511, 0x0538, 0x055F, 0x0588,
+    0x05B1, 0x05DB, 0x0606, 0x0632, 0x065F, 0x068C, 0x06BA, 0x06E9,
+    0x0719, 0x074A, 0x077B, 0x07AE, 0x07E1, 0x0816, 0x084B, 0x0881,
+    0x08B8, 0x08F0, 0x0929, 0x0962, 0x099D, 0x09D9, 0x0A15, 0x0A53,
+    0x0A91, 0x0AD1, 0x0B11, 0x0B53, 0x0B95, 0x0BD9, 0x0C1D, 0x0C63,
+    0x0CA9, 0x0CF1, 0x0D3A, 0x0D83, 0x0DCE, 0x0E1A, 0x0E67, 0x0EB5,
+    0x0F04, 0x0F54, 0x0FA5, 0x0FF8, 0x104B, 0x10A0, 0x10F6, 0x114D,
+    0x11A5, 0x11FE, 0x1258, 0x12B4, 0x1311, 0x136F, 0x13CE, 0x142E,
+    0x1490, 0x14F3, 0x1557, 0x15BC, 0x1623, 0x168A, 0x16F3, 0x175E,
+    0x17C9, 0x1836, 0x18A4, 0x1914, 0x1985, 0x19F7, 0x1A6A, 0x1ADF,
+    0x1B55, 0x1BCC, 0x1C45, 0x1CBF, 0x1D3B, 0x1DB7, 0x1E36, 0x1EB5,
+    0x1F36, 0x1FB9, 0x203D, 0x20C2, 0x2148, 0x21D1, 0x225A, 0x22E5,
+    0x2372, 0x23FF, 0x248F, 0x2520, 0x25B2, 0x2646, 0x26DB, 0x2772,
+    0x280B, 0x28A4, 0x2940, 0x29DD, 0x2A7B, 0x2B1B, 0x2BBD, 0x2C60,
+    0x2D05, 0x2DAC, 0x2E54, 0x2EFD, 0x2FA8, 0x3055, 0x3104, 0x31B4,
+    0x3265, 0x3319, 0x33CE, 0x3484, 0x353D, 0x35F7, 0x36B2, 0x3770,
+    0x382F, 0x38F0, 0x39B2, 0x3A76, 0x3B3C, 0x3C04, 0x3CCD, 0x3D99,
+    0x3E66, 0x3F34, 0x4005, 0x40D7, 0x41AB, 0x4281, 0x4359, 0x4432,
+    0x450E, 0x45EB, 0x46CA, 0x47AB, 0x488D, 0x4972, 0x4A58, 0x4B41,
+    0x4C2B, 0x4D17, 0x4E05, 0x4EF5, 0x4FE6, 0x50DA, 0x51D0, 0x52C7,
+    0x53C1, 0x54BC, 0x55BA, 0x56B9, 0x57BA, 0x58BE, 0x59C3, 0x5ACA,
+    0x5BD4, 0x5CDF, 0x5DEC, 0x5EFC, 0x600D, 0x6121, 0x6236, 0x634E,
+    0x6467, 0x6583, 0x66A1, 0x67C1, 0x68E3, 0x6A07, 0x6B2D, 0x6C55,
+    0x6D80, 0x6EAC, 0x6FDB, 0x710C, 0x723F, 0x7374, 0x74AB, 0x75E5,
+    0x7720, 0x785E, 0x799E, 0x7AE1, 0x7C25, 0x7D6C, 0x7EB5, 0x8000
+};
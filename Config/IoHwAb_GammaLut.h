@@ -0,0 +1,20 @@
+/**********************************************************
+ * @file    IoHwAb_GammaLut.h
+ * @brief   Bảng tra gamma cho độ sáng LED (file sinh tự động)
+ * @details Sinh bởi Config/gen_gamma_lut.py (CIE 1931 lightness, 256 phần tử).
+ *          Không sửa tay, chạy lại: make gamma
+ **********************************************************/
+
+#ifndef IOHWAB_GAMMALUT_H
+#define IOHWAB_GAMMALUT_H
+
+#include <stdint.h>
+
+/* Số bit index của bảng, index = ADC 12-bit >> (12 - IOHWAB_LED_GAMMA_LUT_BITS) */
+#define IOHWAB_LED_GAMMA_LUT_BITS    8U
+#define IOHWAB_LED_GAMMA_LUT_SIZE    256U
+
+/* Duty PWM (0x0000 - 0x8000) theo độ sáng cảm nhận */
+extern const uint16_t IoHwAb_LedGammaLut[IOHWAB_LED_GAMMA_LUT_SIZE];
+
+#endif /* IOHWAB_GAMMALUT_H */
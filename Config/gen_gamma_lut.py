@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""
+@file    gen_gamma_lut.py
+@brief   Sinh bảng tra gamma / CIE lightness cho độ sáng LED (IoHwAb)
+@details Tạo Config/IoHwAb_GammaLut.h và Config/IoHwAb_GammaLut.c.
+         Bảng có 2^bits phần tử, index là giá trị ADC 12-bit dịch phải (12 - bits),
+         giá trị là duty PWM theo thang 0x0000 - 0x8000.
+         Gọi qua Makefile:  make gamma GAMMA_LUT_BITS=8 GAMMA_CURVE=cie
+                            make gamma GAMMA_LUT_BITS=7 GAMMA_CURVE=2.2
+
+@version 1.0
+@date    2025-08-10
+@author  Nguyen Duc Cuong
+"""
+
+import argparse
+import os
+
+DUTY_FULL = 0x8000
+
+
+def cie_lightness(x):
+    """CIE 1931: độ sáng cảm nhận L* (0..1) -> độ chói tương đối Y (0..1)"""
+    lightness = x * 100.0
+    if lightness <= 8.0:
+        return lightness / 903.3
+    return ((lightness + 16.0) / 116.0) ** 3
+
+
+def build_table(bits, curve):
+    size = 1 << bits
+    table = []
+    for i in range(size):
+        x = i / (size - 1)
+        y = cie_lightness(x) if curve == "cie" else x ** float(curve)
+        table.append(min(DUTY_FULL, int(round(y * DUTY_FULL))))
+    return table
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Sinh bảng gamma cho LED PWM")
+    parser.add_argument("--bits", type=int, default=8, help="log2 số phần tử bảng (1..12)")
+    parser.add_argument("--curve", default="cie", help="'cie' hoặc hệ số gamma (vd 2.2)")
+    parser.add_argument("--outdir", default=os.path.dirname(os.path.abspath(__file__)))
+    args = parser.parse_args()
+
+    if not 1 <= args.bits <= 12:
+        parser.error("--bits phải nằm trong khoảng 1..12 (ADC 12-bit)")
+    if args.curve != "cie":
+        float(args.curve)
+
+    table = build_table(args.bits, args.curve)
+    curve_desc = "CIE 1931 lightness" if args.curve == "cie" else "gamma %s" % args.curve
+
+    header = """/**********************************************************
+ * @file    IoHwAb_GammaLut.h
+ * @brief   Bảng tra gamma cho độ sáng LED (file sinh tự động)
+ * @details Sinh bởi Config/gen_gamma_lut.py (%s, %d phần tử).
+ *          Không sửa tay, chạy lại: make gamma
+ **********************************************************/
+
+#ifndef IOHWAB_GAMMALUT_H
+#define IOHWAB_GAMMALUT_H
+
+#include <stdint.h>
+
+/* Số bit index của bảng, index = ADC 12-bit >> (12 - IOHWAB_LED_GAMMA_LUT_BITS) */
+#define IOHWAB_LED_GAMMA_LUT_BITS    %dU
+#define IOHWAB_LED_GAMMA_LUT_SIZE    %dU
+
+/* Duty PWM (0x0000 - 0x8000) theo độ sáng cảm nhận */
+extern const uint16_t IoHwAb_LedGammaLut[IOHWAB_LED_GAMMA_LUT_SIZE];
+
+#endif /* IOHWAB_GAMMALUT_H */
+""" % (curve_desc, len(table), args.bits, len(table))
+
+    rows = []
+    for i in range(0, len(table), 8):
+        rows.append("    " + ", ".join("0x%04X" % v for v in table[i:i + 8]))
+    source = """/**********************************************************
+ * @file    IoHwAb_GammaLut.c
+ * @brief   Bảng tra gamma cho độ sáng LED (file sinh tự động)
+ * @details Sinh bởi Config/gen_gamma_lut.py (%s, %d phần tử).
+ *          Không sửa tay, chạy lại: make gamma
+ **********************************************************/
+
+#include "IoHwAb_GammaLut.h"
+
+const uint16_t IoHwAb_LedGammaLut[IOHWAB_LED_GAMMA_LUT_SIZE] = {
+%s
+};
+""" % (curve_desc, len(table), ",\n".join(rows))
+
+    with open(os.path.join(args.outdir, "IoHwAb_GammaLut.h"), "w", encoding="utf-8") as f:
+        f.write(header)
+    with open(os.path.join(args.outdir, "IoHwAb_GammaLut.c"), "w", encoding="utf-8") as f:
+        f.write(source)
+
+
+if __name__ == "__main__":
+    main()
@@ -11,12 +11,69 @@
 #include "stm32f10x.h"
 #include "misc.h"
 #include "MCAL/Pwm/Pwm.h"
+#include "MCAL/Dio/Dio.h"
+
+void EXTI0_IRQHandler(void)
+{
+    Dio_ExtiIsrHandler(1u << 0);
+}
+
+void EXTI1_IRQHandler(void)
+{
+    Dio_ExtiIsrHandler(1u << 1);
+}
+
+void EXTI2_IRQHandler(void)
+{
+    Dio_ExtiIsrHandler(1u << 2);
+}
+
+void EXTI3_IRQHandler(void)
+{
+    Dio_ExtiIsrHandler(1u << 3);
+}
+
+void EXTI4_IRQHandler(void)
+{
+    Dio_ExtiIsrHandler(1u << 4);
+}
+
+/* Vector dùng chung: xử lý mọi line đang chờ trong một lần vào ngắt */
+void EXTI9_5_IRQHandler(void)
+{
+    Dio_ExtiIsrHandler(DIO_EXTI_LINES_9_5);
+}
+
+void EXTI15_10_IRQHandler(void)
+{
+    Dio_ExtiIsrHandler(DIO_EXTI_LINES_15_10);
+}
+
+void TIM1_UP_IRQHandler(void)
+{
+    Pwm_IsrHandler(TIM1);
+}
+
+void TIM1_CC_IRQHandler(void)
+{
+    Pwm_IsrHandler(TIM1);
+}
 
 void TIM2_IRQHandler(void)
 {
     Pwm_IsrHandler(TIM2);
 }
 
+void TIM3_IRQHandler(void)
+{
+    Pwm_IsrHandler(TIM3);
+}
+
+void TIM4_IRQHandler(void)
+{
+    Pwm_IsrHandler(TIM4);
+}
+
 
 void ADC1_2_IRQHandler(void)
 {
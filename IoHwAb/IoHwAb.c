@@ -10,12 +10,33 @@
  **********************************************************/
 
 #include "IoHwAb.h"
+#include "IoHwAb_GammaLut.h"
+#include "stm32f10x_rcc.h"
 
 #define ADC_INVALID_VALUE 0xFFFF
 
+/* Giới hạn thời gian kick-start: kickStartMs x cycles/ms phải nằm trong uint32 và
+ * nhỏ hơn chu kỳ tràn CYCCNT (~59 s ở 72 MHz) */
+#define IOHWAB_FAN_KICK_MAX_MS  30000U
+
 /* Con trỏ cấu hình toàn cục */
 static const IoHwAb0_ConfigType* IoHwAb0_ConfigPtr = NULL_PTR;
 
+/* Trạng thái quạt: kick-start đo thời gian bằng DWT->CYCCNT, không chặn vòng lặp chính
+ * (CYCCNT tràn sau ~59 s ở 72 MHz, đủ cho thời gian kick vài giây) */
+static boolean IoHwAb0_FanRunning   = FALSE;
+static boolean IoHwAb0_FanKicking   = FALSE;
+static uint8   IoHwAb0_FanTarget    = 0;
+static uint32_t IoHwAb0_FanKickStart = 0;
+static uint32_t IoHwAb0_CyclesPerMs  = 0;
+
+/* Map 0–100% -> 0–0x8000 và ghi ra PWM quạt */
+static void IoHwAb0_ApplyFanPercent(uint8 percent)
+{
+    uint16 duty = (uint16)(((uint32)percent * 0x8000U) / 100U);
+    Pwm_SetDutyCycle(IoHwAb0_ConfigPtr->coolingMotor->pwmChannelId, duty);
+}
+
 Adc_ValueGroupType AdcGroup0Buffer[ADC_GROUP0_BUFFER_SIZE];
 
 /* ================== API khởi tạo ================== */
@@ -28,6 +49,17 @@ void IoHwAb_Init(const IoHwAb0_ConfigType* ConfigPtr)
     Adc_Init(ConfigPtr->IoHwAb0_AdcCfg);
     Pwm_Init(ConfigPtr->IoHwAb0_PwmCfg);
 
+    /* Bật bộ đếm chu kỳ DWT làm mốc thời gian cho kick-start quạt */
+    RCC_ClocksTypeDef clocks;
+    RCC_GetClocksFreq(&clocks);
+    IoHwAb0_CyclesPerMs = clocks.HCLK_Frequency / 1000U;
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    IoHwAb0_FanRunning = FALSE;
+    IoHwAb0_FanKicking = FALSE;
+    IoHwAb0_FanTarget  = 0;
+
 
     Adc_SetupResultBuffer(0, AdcGroup0Buffer);
     Adc_StartGroupConversion(0);
@@ -71,14 +103,61 @@ Std_ReturnType IoHwAb0_SetFanSpeed(uint8 percent)
 
     const CoolingMotorType* motor = IoHwAb0_ConfigPtr->coolingMotor;
 
-    /* Map 0–100% -> 0–0x8000 */
-    uint16 duty = (uint16)(((uint32)percent * 0x8000U) / 100U);
+    /* 0%: dừng quạt, lần chạy sau cần kick-start lại */
+    if (percent == 0U)
+    {
+        IoHwAb0_FanRunning = FALSE;
+        IoHwAb0_FanKicking = FALSE;
+        IoHwAb0_FanTarget  = 0;
+        IoHwAb0_ApplyFanPercent(0);
+        return E_OK;
+    }
+
+    /* Dải trễ bật/tắt: đang dừng thì lệnh nhỏ (nhiễu quanh ngưỡng) không khởi động lại quạt,
+     * tránh chu kỳ dừng -> kick 100% -> dừng liên tục */
+    if (!IoHwAb0_FanRunning && percent < motor->startPercent)
+        return E_OK;
+
+    /* Duty quá nhỏ làm quạt đứng yên nhưng vẫn tốn dòng: nâng lên mức chạy tối thiểu */
+    if (percent < motor->minRunPercent)
+        percent = motor->minRunPercent;
 
-    Pwm_SetDutyCycle(motor->pwmChannelId, duty);
+    IoHwAb0_FanTarget = percent;
 
+    /* Khởi động từ trạng thái dừng: chạy 100% trong kickStartMs rồi mới về duty đích */
+    if (!IoHwAb0_FanRunning && motor->kickStartMs != 0)
+    {
+        IoHwAb0_FanKickStart = DWT->CYCCNT;
+        IoHwAb0_FanKicking = TRUE;
+        IoHwAb0_ApplyFanPercent(100U);
+    }
+    IoHwAb0_FanRunning = TRUE;
+
+    if (!IoHwAb0_FanKicking)
+        IoHwAb0_ApplyFanPercent(percent);
+
+    IoHwAb0_FanMainFunction();
     return E_OK;
 }
 
+/* ================== Kết thúc kick-start khi hết thời gian ================== */
+void IoHwAb0_FanMainFunction(void)
+{
+    if ((IoHwAb0_ConfigPtr == NULL_PTR) || !IoHwAb0_FanKicking)
+        return;
+
+    /* Phép trừ không dấu vẫn đúng khi CYCCNT tràn */
+    uint32_t elapsed = DWT->CYCCNT - IoHwAb0_FanKickStart;
+    uint32_t kickMs = (uint16_t)IoHwAb0_ConfigPtr->coolingMotor->kickStartMs;
+    if (kickMs > IOHWAB_FAN_KICK_MAX_MS) kickMs = IOHWAB_FAN_KICK_MAX_MS;
+
+    if (elapsed >= kickMs * IoHwAb0_CyclesPerMs)
+    {
+        IoHwAb0_FanKicking = FALSE;
+        IoHwAb0_ApplyFanPercent(IoHwAb0_FanTarget);
+    }
+}
+
 void IoHwAb0_ControlFanFromTemperature(void)
 {
     uint16 tempC;
@@ -134,9 +213,11 @@ Std_ReturnType IoHwAb0_ControlLedBrightness(void)
         return E_NOT_OK;
 
     const LEDPwmType* ledPwm = IoHwAb0_ConfigPtr->brightLED;
+    const PotentiometerType* pot = IoHwAb0_ConfigPtr->potentiometer;
 
-    /* Map 0-100% -> 0-0x8000 */
-    uint16 duty = (uint16)(((uint32)potValuePercent * 0x8000U) / 100U);
+    /* Tra bảng gamma (sinh lúc build) theo giá trị ADC thô: độ sáng cảm nhận tuyến tính theo biến trở */
+    uint16_t adcValue = (uint16_t)AdcGroup0Buffer[pot->adcChannelId] & 0x0FFFU;
+    uint16_t duty = IoHwAb_LedGammaLut[adcValue >> (12U - IOHWAB_LED_GAMMA_LUT_BITS)];
     Pwm_SetDutyCycle(ledPwm->pwmChannelId, duty);
 
     return E_OK;
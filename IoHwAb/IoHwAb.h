@@ -36,6 +36,9 @@ Std_ReturnType IoHwAb0_SetFanSpeed(uint8 percent);
 /* Điều khiển LED ON/OFF */
 Std_ReturnType IoHwAb0_SetLedState(boolean state);
 
+/* Kết thúc kick-start của quạt khi hết thời gian, gọi định kỳ trong vòng lặp chính */
+void IoHwAb0_FanMainFunction(void);
+
 /* Cập nhật tốc độ quạt dựa trên nhiệt độ */
 void IoHwAb0_ControlFanFromTemperature(void);
 
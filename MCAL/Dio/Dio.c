@@ -11,71 +11,19 @@
  * =========================================================================================== */
 
 #include "Dio.h"
+#include "stm32f10x_rcc.h"
+#include "misc.h"
+
+/* Bảng dispatch EXTI: line n (chân n) -> ChannelId và callback */
+static Dio_EdgeNotificationType Dio_ExtiCallback[16];
+static Dio_ChannelType          Dio_ExtiChannel[16];
 
 /* ===========================================================================================
  * Fuction Definitions
  * =========================================================================================== */
 
- /********************************************************************************************* 
- * @brief       Đọc trạng thái của 1 Pin       
- * @param       Channel ID
- * @return      Dio_LevelType: STD_HIGH/ STD_LOW
- *********************************************************************************************/
-
- Dio_LevelType Dio_ReadChannel(Dio_ChannelType ChannelId)
-{
-    GPIO_TypeDef *GPIO_Port;
-    uint16_t GPIO_Pin;
-
-    /* Xác định Port GPIO*/
-    GPIO_Port = DIO_GET_PORT_FROM_CHANNEL(ChannelId);
-
-    /* Kiểm tra xem Port có hợp lệ không*/
-    if(GPIO_Port == NULL)
-    {
-        return STD_LOW;
-    }
-
-    /*Xác định chân GPIO*/
-    GPIO_Pin = DIO_GET_PIN(ChannelId);
-
-    /*Đọc trạng thái logic của chân GPIO tương ứng (sử dụng SPL Library)*/
-    if(GPIO_ReadInputDataBit(GPIO_Port, GPIO_Pin) == 1)
-    {
-        return STD_HIGH;
-    }
-    else
-    {
-        return STD_LOW;
-    }
-}
-
- /********************************************************************************************* 
- * @brief       Ghi trạng thái cho 1 Pin       
- * @param       Channel ID, Level
- * @return      void
- *********************************************************************************************/
-
-void Dio_WriteChannel(Dio_ChannelType ChannelId, Dio_LevelType Level)
-{
-    GPIO_TypeDef *GPIO_Port;
-    uint16_t GPIO_Pin;
-
-    /* Xác định Port GPIO*/
-    GPIO_Port = DIO_GET_PORT_FROM_CHANNEL(ChannelId);
-
-    /*Xác định chân GPIO*/
-    GPIO_Pin = DIO_GET_PIN(ChannelId);
+/* Dio_ReadChannel / Dio_WriteChannel: static inline trong Dio.h */
 
-    if(Level == STD_HIGH)
-    {
-        GPIO_SetBits(GPIO_Port, GPIO_Pin);
-    }
-    else
-    {
-        GPIO_ResetBits(GPIO_Port, GPIO_Pin);
-    }
-}
 /********************************************************************************************* 
  * @brief       Đọc trạng thái của 1 Port     
  * @param       PortID
@@ -106,14 +54,9 @@ void Dio_WritePort(Dio_PortType PortId, Dio_PortLevelType Level)
 
     if (GPIO_Port != NULL)
     {
-        if (Level == STD_HIGH)
-        {
-            GPIO_Port->ODR = 0xFFFF;  
-        }
-        else
-        {
-            GPIO_Port->ODR = 0x0000; 
-        }
+        /* Một lệnh BSRR: bit 1 của Level -> set, bit 0 -> reset (16 bit cao) */
+        uint32_t level = (uint16_t)Level;
+        GPIO_Port->BSRR = level | ((~level & 0xFFFFu) << 16);
     }
 }
 
@@ -156,50 +99,313 @@ void Dio_WriteChannelGroup(const Dio_ChannelGroupType* ChannelGroupPtr, Dio_Port
 {
     GPIO_TypeDef* GPIO_Port = DIO_GET_PORT_FROM_GROUP(ChannelGroupPtr);
 
-    /* Sử dụng thanh ghi BSRR/ BRR - ghi dữ liệu cho từng chân*/
-    if (Level == STD_HIGH)
+    if (GPIO_Port == NULL)
     {
-        GPIO_Port->BSRR = ChannelGroupPtr->mask;
+        return;
     }
-    else
+
+    /* Dịch Level về vị trí group, chỉ giữ các chân thuộc mask */
+    uint32_t mask  = (uint16_t)ChannelGroupPtr->mask;
+    uint32_t value = ((uint32_t)(uint16_t)Level << (uint8_t)ChannelGroupPtr->offset) & mask;
+
+    /* Một lệnh BSRR cho cả group: chân mức 1 -> set, chân mức 0 -> reset, chân ngoài mask giữ nguyên */
+    GPIO_Port->BSRR = value | ((~value & mask) << 16);
+}
+
+
+/********************************************************************************************* 
+ * @brief       Gom danh sách yêu cầu ghi thành một Dio_WritePlanType
+ * @param       Plan, danh sách yêu cầu, số phần tử
+ * @return      E_OK / E_NOT_OK
+ *********************************************************************************************/
+Std_ReturnType Dio_PrepareWritePlan(Dio_WritePlanType* Plan, const Dio_ChannelLevelType* List, uint8_t Count)
+{
+    if ((Plan == NULL) || ((List == NULL) && (Count > 0u)))
     {
-        GPIO_Port->BRR = ChannelGroupPtr->mask;
+        return E_NOT_OK;
     }
-}
 
+    for (uint8_t port = 0; port < DIO_NUM_PORTS; port++)
+    {
+        Plan->bsrr[port] = 0;
+    }
+    Plan->portMask = 0;
+
+    for (uint8_t i = 0; i < Count; i++)
+    {
+        uint8_t port = (uint8_t)List[i].ChannelId >> 4;
+        if (port >= DIO_NUM_PORTS)
+        {
+            Plan->portMask = 0;
+            return E_NOT_OK;
+        }
+
+        uint32_t pin = DIO_GET_PIN(List[i].ChannelId);
+
+        /* Xóa yêu cầu cũ của chân (cả BS và BR) rồi đặt yêu cầu mới */
+        Plan->bsrr[port] &= ~(pin | (pin << 16));
+        Plan->bsrr[port] |= (List[i].Level == STD_HIGH) ? pin : (pin << 16);
+        Plan->portMask |= (uint8_t)(1u << port);
+    }
+
+    return E_OK;
+}
 
 /********************************************************************************************* 
- * @brief       Lấy dữ liệu về version của software đang dùng    
- * @param       Con trỏ VersionInfo
+ * @brief       Thực thi Dio_WritePlanType: mỗi Port một lệnh ghi BSRR
+ * @param       Con trỏ tới plan đã chuẩn bị
  * @return      void
  *********************************************************************************************/
+void Dio_ExecuteWritePlan(const Dio_WritePlanType* Plan)
+{
+    if (Plan == NULL)
+    {
+        return;
+    }
 
-void Dio_GetVersionInfo (Std_VersionInfoType* VersionInfo)
+    uint8_t ports = Plan->portMask;
+    while (ports)
+    {
+        uint8_t port = (uint8_t)__builtin_ctz(ports);
+        ports &= (uint8_t)(ports - 1u);
+        Dio_PortBase[port]->BSRR = Plan->bsrr[port];
+    }
+}
+
+/********************************************************************************************* 
+ * @brief       Ghi nhiều chân cùng lúc, tối đa một BSRR mỗi Port
+ * @param       Danh sách yêu cầu, số phần tử
+ * @return      E_OK / E_NOT_OK
+ *********************************************************************************************/
+Std_ReturnType Dio_WriteMulti(const Dio_ChannelLevelType* List, uint8_t Count)
 {
-    VersionInfo->vendorID = 0x1234;
-    VersionInfo->moduleID = 0x5678;
-    VersionInfo->sw_major_version = 1;
-    VersionInfo->sw_minor_version = 0;
-    VersionInfo->sw_patch_version = 0;
+    Dio_WritePlanType plan;
+
+    if (Dio_PrepareWritePlan(&plan, List, Count) != E_OK)
+    {
+        return E_NOT_OK;
+    }
+
+    Dio_ExecuteWritePlan(&plan);
+    return E_OK;
+}
+
+/********************************************************************************************* 
+ * @brief       Khởi tạo bộ chống dội cho 1 Port
+ * @param       Con trỏ bộ chống dội, PortId
+ * @return      E_OK / E_NOT_OK
+ *********************************************************************************************/
+Std_ReturnType Dio_DebounceInit(Dio_DebounceType* Debounce, Dio_PortType PortId)
+{
+    if ((Debounce == NULL) || (DIO_GET_PORT_FROM_PORT(PortId) == NULL))
+    {
+        return E_NOT_OK;
+    }
+
+    Debounce->port    = PortId;
+    Debounce->state   = (uint16_t)Dio_ReadPort(PortId);
+    Debounce->cnt0    = 0;
+    Debounce->cnt1    = 0;
+    Debounce->changed = 0;
+
+    return E_OK;
+}
+
+/********************************************************************************************* 
+ * @brief       Lấy mẫu Port một lần và cập nhật bộ đếm dọc
+ * @details     delta = các chân khác trạng thái đã lọc. Chân có delta = 0 bị reset bộ đếm,
+ *              chân có delta = 1 đếm 0 -> 1 -> 2 -> 3 -> 0, khi quay về 0 thì đảo trạng thái.
+ * @param       Con trỏ bộ chống dội
+ * @return      Mask các chân vừa đổi trạng thái
+ *********************************************************************************************/
+uint16_t Dio_DebounceMainFunction(Dio_DebounceType* Debounce)
+{
+    if (Debounce == NULL)
+    {
+        return 0;
+    }
+
+    uint16_t sample = (uint16_t)Dio_ReadPort(Debounce->port);
+    uint16_t delta  = (uint16_t)(sample ^ Debounce->state);
+
+    Debounce->cnt1 = (uint16_t)((Debounce->cnt1 ^ Debounce->cnt0) & delta);
+    Debounce->cnt0 = (uint16_t)(~Debounce->cnt0 & delta);
+
+    uint16_t toggle = (uint16_t)(delta & ~(Debounce->cnt0 | Debounce->cnt1));
+    Debounce->state   ^= toggle;
+    Debounce->changed |= toggle;
+
+    return toggle;
+}
+
+/********************************************************************************************* 
+ * @brief       Đọc trạng thái đã chống dội của cả Port
+ * @param       Con trỏ bộ chống dội
+ * @return      Dio_PortLevelType
+ *********************************************************************************************/
+Dio_PortLevelType Dio_DebounceGetState(const Dio_DebounceType* Debounce)
+{
+    if (Debounce == NULL)
+    {
+        return 0;
+    }
+
+    return (Dio_PortLevelType)Debounce->state;
+}
+
+/********************************************************************************************* 
+ * @brief       Lấy và xóa mask các chân đã đổi trạng thái
+ * @details     Đọc và xóa trong vùng tắt ngắt, an toàn khi MainFunction chạy trong ISR tick
+ * @param       Con trỏ bộ chống dội
+ * @return      Mask thay đổi
+ *********************************************************************************************/
+uint16_t Dio_DebounceGetChanges(Dio_DebounceType* Debounce)
+{
+    if (Debounce == NULL)
+    {
+        return 0;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint16_t changed = Debounce->changed;
+    Debounce->changed = 0;
+    __set_PRIMASK(primask);
+
+    return changed;
+}
+
+/********************************************************************************************* 
+ * @brief       Vector NVIC phục vụ line EXTI
+ *********************************************************************************************/
+static IRQn_Type Dio_ExtiIrq(uint8_t line)
+{
+    if (line <= 4u)
+    {
+        return (IRQn_Type)(EXTI0_IRQn + line);
+    }
+    return (line <= 9u) ? EXTI9_5_IRQn : EXTI15_10_IRQn;
 }
 
 /********************************************************************************************* 
- * @brief       Đảo ngược trạng thái của 1 channel   
+ * @brief       Bật thông báo cạnh qua EXTI cho 1 chân input
+ * @param       ChannelId, cạnh kích hoạt, callback
+ * @return      E_OK / E_NOT_OK
+ *********************************************************************************************/
+Std_ReturnType Dio_EnableEdgeNotification(Dio_ChannelType ChannelId, Dio_EdgeType Edge,
+                                          Dio_EdgeNotificationType Callback)
+{
+    if (!DIO_IS_VALID_CHANNEL(ChannelId) || (Callback == NULL) || ((Edge & DIO_EDGE_BOTH) == 0))
+    {
+        return E_NOT_OK;
+    }
+
+    uint8_t  line = (uint8_t)ChannelId & 0x0Fu;
+    uint8_t  port = (uint8_t)ChannelId >> 4;
+    uint32_t bit  = 1u << line;
+
+    /* Line đã gắn với chân cùng số ở Port khác */
+    if ((Dio_ExtiCallback[line] != NULL) && (Dio_ExtiChannel[line] != ChannelId))
+    {
+        return E_NOT_OK;
+    }
+
+    /* Tắt line trong lúc đổi cấu hình */
+    EXTI->IMR &= ~bit;
+
+    Dio_ExtiChannel[line]  = ChannelId;
+    Dio_ExtiCallback[line] = Callback;
+
+    /* AFIO EXTICR: chọn Port cho line */
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO, ENABLE);
+    GPIO_EXTILineConfig(port, line);
+
+    if (Edge & DIO_EDGE_RISING)  EXTI->RTSR |= bit; else EXTI->RTSR &= ~bit;
+    if (Edge & DIO_EDGE_FALLING) EXTI->FTSR |= bit; else EXTI->FTSR &= ~bit;
+
+    /* Bỏ cờ cũ để không gọi callback cho cạnh xảy ra trước khi bật */
+    EXTI->PR   = bit;
+    EXTI->EMR &= ~bit;
+    EXTI->IMR |= bit;
+
+    NVIC_InitTypeDef nvic;
+    nvic.NVIC_IRQChannel = (uint8_t)Dio_ExtiIrq(line);
+    nvic.NVIC_IRQChannelPreemptionPriority = 0;
+    nvic.NVIC_IRQChannelSubPriority = 0;
+    nvic.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&nvic);
+
+    return E_OK;
+}
+
+/********************************************************************************************* 
+ * @brief       Tắt thông báo cạnh EXTI của 1 chân
+ * @details     Vector dùng chung (9_5, 15_10) vẫn bật, line đã tắt không còn tạo cờ
  * @param       ChannelId
- * @return      STD_HIGH/ STD_LOW
+ * @return      void
  *********************************************************************************************/
-Dio_LevelType Dio_FlipChannel (Dio_ChannelType ChannelId)
+void Dio_DisableEdgeNotification(Dio_ChannelType ChannelId)
 {
-    Dio_LevelType currentLevel = Dio_ReadChannel(ChannelId);
+    if (!DIO_IS_VALID_CHANNEL(ChannelId))
+    {
+        return;
+    }
+
+    uint8_t  line = (uint8_t)ChannelId & 0x0Fu;
+    uint32_t bit  = 1u << line;
 
-    if (currentLevel == STD_HIGH)
+    if (Dio_ExtiChannel[line] != ChannelId)
     {
-        Dio_WriteChannel(ChannelId, STD_LOW);
-        return STD_LOW;
+        return;
     }
-    else
+
+    EXTI->IMR  &= ~bit;
+    EXTI->RTSR &= ~bit;
+    EXTI->FTSR &= ~bit;
+    EXTI->PR    = bit;
+
+    Dio_ExtiCallback[line] = NULL;
+}
+
+/********************************************************************************************* 
+ * @brief       Xử lý ngắt EXTI cho các line trong LineMask
+ * @param       Mask line của vector
+ * @return      void
+ *********************************************************************************************/
+void Dio_ExtiIsrHandler(uint32_t LineMask)
+{
+    /* Đọc PR một lần, chỉ giữ line đang bật ngắt thuộc vector này */
+    uint32_t pending = EXTI->PR & EXTI->IMR & LineMask;
+
+    /* PR là rc_w1: ghi 1 để xóa đúng các line vừa đọc */
+    EXTI->PR = pending;
+
+    while (pending)
     {
-        Dio_WriteChannel(ChannelId, STD_HIGH);
-        return STD_HIGH;
+        uint8_t line = (uint8_t)__builtin_ctz(pending);
+        pending &= pending - 1u;
+
+        Dio_EdgeNotificationType cb = Dio_ExtiCallback[line];
+        if (cb != NULL)
+        {
+            cb(Dio_ExtiChannel[line]);
+        }
     }
 }
+
+/********************************************************************************************* 
+ * @brief       Lấy dữ liệu về version của software đang dùng    
+ * @param       Con trỏ VersionInfo
+ * @return      void
+ *********************************************************************************************/
+
+void Dio_GetVersionInfo (Std_VersionInfoType* VersionInfo)
+{
+    VersionInfo->vendorID = 0x1234;
+    VersionInfo->moduleID = 0x5678;
+    VersionInfo->sw_major_version = 1;
+    VersionInfo->sw_minor_version = 0;
+    VersionInfo->sw_patch_version = 0;
+}
+
+/* Dio_FlipChannel: static inline trong Dio.h */
@@ -35,26 +35,57 @@
 #define DIO_PORT_C   2u
 #define DIO_PORT_D   3u
 
+#define DIO_NUM_PORTS   4u
+
+/********************************************************************************************* 
+ * @brief        Bảng địa chỉ GPIO theo PortId
+ * @details      ChannelId = PortId * 16 + Pin nên PortId = ChannelId >> 4, tra bảng một lần
+ *               thay cho chuỗi so sánh. Với ChannelId hằng, compiler gấp luôn thành địa chỉ.
+ *********************************************************************************************/
+static GPIO_TypeDef* const Dio_PortBase[DIO_NUM_PORTS] = { GPIOA, GPIOB, GPIOC, GPIOD };
+
 /********************************************************************************************* 
  * @brief        Xác định port và pin của chân GPIO dựa trên ChannelID 
  *********************************************************************************************/
 /* Xác định Port dựa vào PortId*/
-#define DIO_GET_PORT_FROM_PORT(PortId)                                                                 \
-        ((PortId == 0) ? GPIOA : ((PortId == 1) ? GPIOB : ((PortId == 2) ? GPIOC :                   \
-        ((PortId == 3) ? GPIOD : NULL))))
+#define DIO_GET_PORT_FROM_PORT(PortId)                                                               \
+        (((uint8_t)(PortId) < DIO_NUM_PORTS) ? Dio_PortBase[(uint8_t)(PortId)] : NULL)
 
 /* Xác định Port dựa vào ChannelGroupPtr*/ 
-#define DIO_GET_PORT_FROM_GROUP(ChannelGroupPtr)                                                     \
-        ((ChannelGroupPtr->port == 0) ? GPIOA : ((ChannelGroupPtr->port == 1) ? GPIOB :              \
-        ((ChannelGroupPtr->port == 2) ? GPIOC : ((ChannelGroupPtr->port == 3) ? GPIOD : NULL))))
+#define DIO_GET_PORT_FROM_GROUP(ChannelGroupPtr)    DIO_GET_PORT_FROM_PORT((ChannelGroupPtr)->port)
 
-/* Xác định Port dựa vào ChannelId*/ 
-#define DIO_GET_PORT_FROM_CHANNEL(ChannelId)                                                         \
-        ((ChannelId < 16) ? GPIOA : ((ChannelId < 32) ? GPIOB : ((ChannelId < 64) ? GPIOC :          \
-        ((ChannelId < 96) ? GPIOD : NULL))))
+/* Xác định Port dựa vào ChannelId (16 chân mỗi Port)*/ 
+#define DIO_GET_PORT_FROM_CHANNEL(ChannelId)        DIO_GET_PORT_FROM_PORT((uint8_t)(ChannelId) >> 4)
 
 /*Xác định Pin dựa vào ChannelId*/
-#define DIO_GET_PIN(ChannelId)       (1 << ((ChannelId) % 16))                                                                    
+#define DIO_GET_PIN(ChannelId)       ((uint16_t)(1u << ((uint8_t)(ChannelId) & 0x0Fu)))
+
+/********************************************************************************************* 
+ * @brief        Truy cập bit-band cho Dio_ReadChannel / Dio_WriteChannel / Dio_FlipChannel
+ * @details      DIO_USE_BITBAND = 1: mỗi chân có một word alias trong vùng 0x42000000,
+ *               đọc/ghi word đó = đọc/ghi đúng 1 bit IDR/ODR, nguyên tử theo phần cứng.
+ *               Địa chỉ alias tính từ ChannelId bằng hằng số (GPIOA..GPIOD cách nhau 0x400).
+ *               Chọn khi build: make DIO_BITBAND=1
+ *********************************************************************************************/
+#ifndef DIO_USE_BITBAND
+#define DIO_USE_BITBAND     0
+#endif
+
+/* Địa chỉ thanh ghi GPIO của Port chứa ChannelId */
+#define DIO_PORT_BASE_ADDR(ChannelId)    (GPIOA_BASE + ((uint32_t)((uint8_t)(ChannelId) >> 4) * 0x400u))
+
+/* Alias bit-band: PERIPH_BB_BASE + (offset thanh ghi x 32) + (bit x 4) */
+#define DIO_BITBAND_ADDR(RegAddr, Bit)   (PERIPH_BB_BASE + (((RegAddr) - PERIPH_BASE) * 32u) + ((uint32_t)(Bit) * 4u))
+
+#define DIO_BB_IDR(ChannelId)                                                                        \
+        (*(volatile uint32_t*)DIO_BITBAND_ADDR(DIO_PORT_BASE_ADDR(ChannelId) + offsetof(GPIO_TypeDef, IDR), \
+                                               (uint8_t)(ChannelId) & 0x0Fu))
+#define DIO_BB_ODR(ChannelId)                                                                        \
+        (*(volatile uint32_t*)DIO_BITBAND_ADDR(DIO_PORT_BASE_ADDR(ChannelId) + offsetof(GPIO_TypeDef, ODR), \
+                                               (uint8_t)(ChannelId) & 0x0Fu))
+
+/* ChannelId thuộc Port có trong bảng Dio_PortBase */
+#define DIO_IS_VALID_CHANNEL(ChannelId)  (((uint8_t)(ChannelId) >> 4) < DIO_NUM_PORTS)
 
 
 /**
@@ -142,23 +173,6 @@ typedef uint8       Dio_ChannelType;
  *               sử dụng kiểu uint8 (đủ cho số Port trong 1 vi điều khiển bất kì)
  *********************************************************************************************/
 
-/* Bảng ánh xạ PWM ChannelNumber -> Dio_ChannelType tương ứng*/
-static const Dio_ChannelType PwmToDioChannelMap[] = {
-    DIO_CHANNEL_A0,  // PWM_CHANNEL_TIM2_CH1
-    DIO_CHANNEL_A1,  // PWM_CHANNEL_TIM2_CH2
-    DIO_CHANNEL_A2,  // PWM_CHANNEL_TIM2_CH3
-    DIO_CHANNEL_A3,  // PWM_CHANNEL_TIM2_CH4
-    DIO_CHANNEL_A6,  // PWM_CHANNEL_TIM3_CH1
-    DIO_CHANNEL_A7,  // PWM_CHANNEL_TIM3_CH2
-    DIO_CHANNEL_B0,  // PWM_CHANNEL_TIM3_CH3
-    DIO_CHANNEL_B1,  // PWM_CHANNEL_TIM3_CH4
-    DIO_CHANNEL_B6,  // PWM_CHANNEL_TIM4_CH1
-    DIO_CHANNEL_B7,  // PWM_CHANNEL_TIM4_CH2
-    DIO_CHANNEL_B8,  // PWM_CHANNEL_TIM4_CH3
-    DIO_CHANNEL_B9   // PWM_CHANNEL_TIM4_CH4
-};
-
-
 typedef uint8       Dio_PortType;
 
 /********************************************************************************************* 
@@ -194,25 +208,126 @@ typedef uint8        Dio_LevelType;
 
 typedef uint16       Dio_PortLevelType;
 
+/********************************************************************************************* 
+ * @struct       Dio_ChannelLevelType
+ * @brief        Một yêu cầu ghi: chân và mức logic cần xuất
+ *********************************************************************************************/
+
+typedef struct
+{
+    Dio_ChannelType ChannelId;               /*<< Chân cần ghi*/
+    Dio_LevelType   Level;                   /*<< STD_HIGH / STD_LOW*/
+} Dio_ChannelLevelType;
+
+/********************************************************************************************* 
+ * @struct       Dio_WritePlanType
+ * @brief        Danh sách ghi đã gom theo Port
+ * @details      Mỗi Port có sẵn một word BSRR (set ở 16 bit thấp, reset ở 16 bit cao),
+ *               khi thực thi chỉ ghi các Port có bit trong portMask.
+ *********************************************************************************************/
+
+typedef struct
+{
+    uint32_t bsrr[DIO_NUM_PORTS];            /*<< Giá trị BSRR cho từng Port*/
+    uint8_t  portMask;                       /*<< Bit n = 1: Port n có chân cần ghi*/
+} Dio_WritePlanType;
+
+/********************************************************************************************* 
+ * @struct       Dio_DebounceType
+ * @brief        Trạng thái chống dội cho 16 chân của 1 Port
+ * @details      Bộ đếm dọc 2 bit (cnt1:cnt0) cho mỗi chân, xử lý song song cả 16 bit bằng
+ *               vài phép toán bit. Chân phải khác trạng thái đã lọc 4 lần lấy mẫu liên tiếp
+ *               thì mới được chấp nhận. Chi phí mỗi tick cố định, không phụ thuộc số chân.
+ *********************************************************************************************/
+
+typedef struct
+{
+    Dio_PortType port;                       /*<< Port được lấy mẫu*/
+    uint16_t     state;                      /*<< Trạng thái đã chống dội*/
+    uint16_t     cnt0;                       /*<< Bit 0 của bộ đếm dọc*/
+    uint16_t     cnt1;                       /*<< Bit 1 của bộ đếm dọc*/
+    uint16_t     changed;                    /*<< Các chân đã đổi trạng thái từ lần đọc trước*/
+} Dio_DebounceType;
+
+/********************************************************************************************* 
+ * @enum         Dio_EdgeType
+ * @brief        Cạnh kích hoạt thông báo EXTI của 1 chân
+ *********************************************************************************************/
+
+typedef enum
+{
+    DIO_EDGE_RISING  = 0x01,                 /*<< Cạnh lên*/
+    DIO_EDGE_FALLING = 0x02,                 /*<< Cạnh xuống*/
+    DIO_EDGE_BOTH    = 0x03                  /*<< Cả hai cạnh*/
+} Dio_EdgeType;
+
+/* Callback thông báo cạnh, tham số là ChannelId gây ngắt */
+typedef void (*Dio_EdgeNotificationType)(Dio_ChannelType ChannelId);
+
+/* Mask line EXTI của các vector dùng chung */
+#define DIO_EXTI_LINES_9_5      0x03E0u
+#define DIO_EXTI_LINES_15_10    0xFC00u
+
 /* ===========================================================================================
  * Fuction Decalarations
  * =========================================================================================== */
 
 /********************************************************************************************* 
  * @brief       Đọc trạng thái của 1 Pin       
+ * @details     Inline: với ChannelId hằng chỉ còn một lệnh đọc IDR
  * @param       Channel ID
  * @return      Dio_LevelType: STD_HIGH/ STD_LOW
  *********************************************************************************************/
 
-Dio_LevelType Dio_ReadChannel(Dio_ChannelType ChannelID);
+static inline Dio_LevelType Dio_ReadChannel(Dio_ChannelType ChannelId)
+{
+#if DIO_USE_BITBAND
+    if (!DIO_IS_VALID_CHANNEL(ChannelId))
+    {
+        return STD_LOW;
+    }
+
+    return DIO_BB_IDR(ChannelId) ? STD_HIGH : STD_LOW;
+#else
+    GPIO_TypeDef* GPIO_Port = DIO_GET_PORT_FROM_CHANNEL(ChannelId);
+
+    /* Kiểm tra xem Port có hợp lệ không*/
+    if (GPIO_Port == NULL)
+    {
+        return STD_LOW;
+    }
+
+    return (GPIO_Port->IDR & DIO_GET_PIN(ChannelId)) ? STD_HIGH : STD_LOW;
+#endif
+}
 
  /********************************************************************************************* 
  * @brief       Ghi trạng thái cho 1 Pin       
+ * @details     Inline: với ChannelId hằng chỉ còn một lệnh ghi BSRR
+ *              (16 bit thấp set, 16 bit cao reset, không read-modify-write ODR)
  * @param       Channel ID, Level
  * @return      void
  *********************************************************************************************/
 
-void Dio_WriteChannel(Dio_ChannelType ChannelId, Dio_LevelType Level);
+static inline void Dio_WriteChannel(Dio_ChannelType ChannelId, Dio_LevelType Level)
+{
+#if DIO_USE_BITBAND
+    if (DIO_IS_VALID_CHANNEL(ChannelId))
+    {
+        DIO_BB_ODR(ChannelId) = (Level == STD_HIGH) ? 1u : 0u;
+    }
+#else
+    GPIO_TypeDef* GPIO_Port = DIO_GET_PORT_FROM_CHANNEL(ChannelId);
+
+    if (GPIO_Port == NULL)
+    {
+        return;
+    }
+
+    GPIO_Port->BSRR = (Level == STD_HIGH) ? (uint32_t)DIO_GET_PIN(ChannelId)
+                                          : ((uint32_t)DIO_GET_PIN(ChannelId) << 16);
+#endif
+}
 
 /********************************************************************************************* 
  * @brief       Đọc trạng thái của 1 Port     
@@ -237,12 +352,88 @@ Dio_PortLevelType Dio_ReadChannelGroup(const Dio_ChannelGroupType* ChannelGroupP
 
 /********************************************************************************************* 
  * @brief       Ghi trạng thái logic cho một GroupChannel    
+ * @details     Level được dịch trái offset và lọc theo mask, ghi bằng một lệnh BSRR
  * @param       Con trỏ trỏ đến 1  ChannelGroup, PortLevel
  * @return      void
  *********************************************************************************************/
 
 void Dio_WriteChannelGroup(const Dio_ChannelGroupType* ChannelGroupIdPtr, Dio_PortLevelType Level);
 
+/********************************************************************************************* 
+ * @brief       Gom danh sách yêu cầu ghi thành một Dio_WritePlanType (làm một lần, dùng nhiều lần)
+ * @details     Chân xuất hiện nhiều lần thì yêu cầu sau cùng được giữ
+ * @param       Plan, danh sách yêu cầu, số phần tử
+ * @return      E_OK / E_NOT_OK nếu con trỏ NULL hoặc có chân không hợp lệ
+ *********************************************************************************************/
+Std_ReturnType Dio_PrepareWritePlan(Dio_WritePlanType* Plan, const Dio_ChannelLevelType* List, uint8_t Count);
+
+/********************************************************************************************* 
+ * @brief       Thực thi Dio_WritePlanType: mỗi Port có thay đổi chỉ một lệnh ghi BSRR
+ * @param       Con trỏ tới plan đã chuẩn bị
+ * @return      void
+ *********************************************************************************************/
+void Dio_ExecuteWritePlan(const Dio_WritePlanType* Plan);
+
+/********************************************************************************************* 
+ * @brief       Ghi nhiều chân cùng lúc, gom theo Port rồi ghi tối đa một BSRR mỗi Port
+ * @param       Danh sách yêu cầu, số phần tử
+ * @return      E_OK / E_NOT_OK (không ghi gì nếu danh sách có chân không hợp lệ)
+ *********************************************************************************************/
+Std_ReturnType Dio_WriteMulti(const Dio_ChannelLevelType* List, uint8_t Count);
+
+/********************************************************************************************* 
+ * @brief       Khởi tạo bộ chống dội cho 1 Port, trạng thái ban đầu lấy từ IDR hiện tại
+ * @param       Con trỏ bộ chống dội, PortId
+ * @return      E_OK / E_NOT_OK
+ *********************************************************************************************/
+Std_ReturnType Dio_DebounceInit(Dio_DebounceType* Debounce, Dio_PortType PortId);
+
+/********************************************************************************************* 
+ * @brief       Lấy mẫu Port một lần và cập nhật bộ đếm dọc, gọi định kỳ (vd mỗi 5 ms)
+ * @param       Con trỏ bộ chống dội
+ * @return      Mask các chân vừa đổi trạng thái ở tick này
+ *********************************************************************************************/
+uint16_t Dio_DebounceMainFunction(Dio_DebounceType* Debounce);
+
+/********************************************************************************************* 
+ * @brief       Đọc trạng thái đã chống dội của cả Port
+ * @param       Con trỏ bộ chống dội
+ * @return      Dio_PortLevelType
+ *********************************************************************************************/
+Dio_PortLevelType Dio_DebounceGetState(const Dio_DebounceType* Debounce);
+
+/********************************************************************************************* 
+ * @brief       Lấy và xóa mask các chân đã đổi trạng thái kể từ lần gọi trước
+ * @param       Con trỏ bộ chống dội
+ * @return      Mask thay đổi
+ *********************************************************************************************/
+uint16_t Dio_DebounceGetChanges(Dio_DebounceType* Debounce);
+
+/********************************************************************************************* 
+ * @brief       Bật thông báo cạnh qua EXTI cho 1 chân input
+ * @details     Line EXTI = số chân (0..15), mỗi line chỉ gắn được với 1 Port (AFIO EXTICR).
+ *              Chân phải được cấu hình input trong Port trước.
+ * @param       ChannelId, cạnh kích hoạt, callback
+ * @return      E_OK / E_NOT_OK nếu tham số sai hoặc line đang dùng cho Port khác
+ *********************************************************************************************/
+Std_ReturnType Dio_EnableEdgeNotification(Dio_ChannelType ChannelId, Dio_EdgeType Edge,
+                                          Dio_EdgeNotificationType Callback);
+
+/********************************************************************************************* 
+ * @brief       Tắt thông báo cạnh EXTI của 1 chân
+ * @param       ChannelId
+ * @return      void
+ *********************************************************************************************/
+void Dio_DisableEdgeNotification(Dio_ChannelType ChannelId);
+
+/********************************************************************************************* 
+ * @brief       Xử lý ngắt EXTI, gọi từ EXTIx_IRQHandler với mask các line của vector đó
+ * @details     Đọc PR một lần, xóa đúng các line đang chờ, tra bảng line -> callback O(1)
+ * @param       Mask line của vector (vd DIO_EXTI_LINES_9_5)
+ * @return      void
+ *********************************************************************************************/
+void Dio_ExtiIsrHandler(uint32_t LineMask);
+
 /********************************************************************************************* 
  * @brief       Lấy dữ liệu về version của software đang dùng    
  * @param       Con trỏ VersionInfo
@@ -253,9 +444,43 @@ void Dio_GetVersionInfo (Std_VersionInfoType* VersionInfo);
 
 /********************************************************************************************* 
  * @brief       Đảo ngược trạng thái của 1 channel   
+ * @details     Mức mới lấy từ ODR (mức đang xuất, không phải IDR) và ghi bằng một lệnh BSRR
+ *              set hoặc reset đúng chân đó, không ảnh hưởng chân khác dù ISR ghi cùng Port.
  * @param       ChannelId
  * @return      STD_HIGH/ STD_LOW
  *********************************************************************************************/
-Dio_LevelType Dio_FlipChannel (Dio_ChannelType ChannelId);
+static inline Dio_LevelType Dio_FlipChannel (Dio_ChannelType ChannelId)
+{
+#if DIO_USE_BITBAND
+    if (!DIO_IS_VALID_CHANNEL(ChannelId))
+    {
+        return STD_LOW;
+    }
+
+    /* Đọc/ghi trực tiếp bit ODR qua alias, không đụng các chân khác của Port */
+    uint32_t newLevel = DIO_BB_ODR(ChannelId) ^ 1u;
+    DIO_BB_ODR(ChannelId) = newLevel;
+    return newLevel ? STD_HIGH : STD_LOW;
+#else
+    GPIO_TypeDef* GPIO_Port = DIO_GET_PORT_FROM_CHANNEL(ChannelId);
+
+    if (GPIO_Port == NULL)
+    {
+        return STD_LOW;
+    }
+
+    uint32_t pin = DIO_GET_PIN(ChannelId);
+
+    /* Chân đang cao -> reset (BR, 16 bit cao), đang thấp -> set (BS, 16 bit thấp) */
+    if (GPIO_Port->ODR & pin)
+    {
+        GPIO_Port->BSRR = pin << 16;
+        return STD_LOW;
+    }
+
+    GPIO_Port->BSRR = pin;
+    return STD_HIGH;
+#endif
+}
 
 #endif /*DIO.h*/
\ No newline at end of file
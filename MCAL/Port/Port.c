@@ -23,106 +23,167 @@
 static uint8_t Port_Initialized = 0;               /* Trạng thái đã init */
 static const Port_ConfigType* Port_ConfigPtr = NULL;  /* Lưu con trỏ config runtime */
 
+#define PORT_NUM_PORTS  4U
+
+/*
+ * Ảnh thanh ghi của từng Port, dựng một lần trong Port_Init từ toàn bộ cấu hình pin
+ * cr[0] = CRL (pin 0..7), cr[1] = CRH (pin 8..15), mỗi pin một nibble CNF[1:0]:MODE[1:0]
+ */
+typedef struct {
+    uint32_t cr[2];       /* Giá trị nibble mong muốn của các chân có cấu hình */
+    uint32_t crMask[2];   /* Nibble thuộc các chân có cấu hình */
+    uint32_t refreshMask[2]; /* Nibble của các chân không cho đổi chiều (được Refresh kiểm tra) */
+    uint32_t bsrr;        /* Mức ODR ban đầu: bit thấp = set, bit cao = reset */
+    uint16_t pinMask;     /* Các chân của Port có trong cấu hình */
+    uint16_t lockMask;    /* Các chân không cho đổi chiều lẫn mode: khóa bằng LCKR */
+} Port_ImageType;
+
+static Port_ImageType Port_Image[PORT_NUM_PORTS];
+
+/* Số nibble CRL/CRH bị lệch đã được Port_RefreshPortDirection ghi lại */
+static uint32_t Port_RefreshCorrections = 0;
+
+/* Pin ID (0..63) -> index trong PinConfigs, dựng trong Port_Init */
+#define PORT_NUM_PINS   (PORT_NUM_PORTS * 16U)
+#define PORT_NO_INDEX   0xFFU
+static uint8_t Port_PinIndex[PORT_NUM_PINS];
+
 /* ===============================
  *      Internal Helper Function
  * =============================== */
 
 /* 
- * Tìm index trong mảng cấu hình dựa vào số hiệu Pin
- * @return index >= 0 nếu tìm thấy, -1 nếu không tìm thấy
+ * Tìm index trong mảng cấu hình dựa vào số hiệu Pin (tra bảng Port_PinIndex)
+ * @return index trong PinConfigs, PORT_NO_INDEX nếu không tìm thấy
  */
-static sint16 Port_FindPinIndex(Port_PinType Pin)
+static inline uint8_t Port_FindPinIndex(Port_PinType Pin)
 {
-    if (Port_ConfigPtr == NULL) return -1;
-
-    for (uint16_t i = 0; i < Port_ConfigPtr->PinCount; i++)
-    {
-        if (Port_ConfigPtr->PinConfigs[i].Pin == Pin)
-            return i;
-    }
-    return -1;
+    uint8_t pinId = (uint8_t)Pin;
+    return (pinId < PORT_NUM_PINS) ? Port_PinIndex[pinId] : PORT_NO_INDEX;
 }
 
-/* 
- * Cấu hình 1 pin GPIO dựa trên thông số AUTOSAR
+/*
+ * Tính nibble CNF:MODE của 1 pin theo Mode/Direction
+ * Mã hóa giống GPIO_Init: nibble = GPIO_Mode & 0x0F, output thì OR thêm tốc độ
+ * @param odrLevel  Mức ODR cần ghi: 1 / 0, -1 nếu chân không dùng ODR
  */
-static void Port_ApplyPinConfig(const Port_PinConfigType* pinCfg) 
+static uint8_t Port_CalcPinNibble(const Port_PinConfigType* pinCfg, Port_PinModeType mode,
+                                  Port_PinDirectionType direction, int8_t* odrLevel)
 {
-    GPIO_InitTypeDef GPIO_InitStruct;
+    GPIOMode_TypeDef gpioMode;
+    GPIOSpeed_TypeDef speed;
 
-    Port_PinType pinId = pinCfg->Pin;
-    uint8_t portNum = PORT_GET_PORT_NUM(pinId);
-    uint8_t pinNum  = PORT_GET_PIN_NUM(pinId);
-    uint16_t pinMask = (1U << pinNum);
+    if (pinCfg->Speed == SPEED_SMALL)       speed = GPIO_Speed_2MHz;
+    else if (pinCfg->Speed == SPEED_MEDIUM) speed = GPIO_Speed_10MHz;
+    else                                    speed = GPIO_Speed_50MHz;
 
-    /* Kích hoạt clock cho PORT */
-    switch (portNum) 
+    if (mode == PORT_PIN_MODE_ADC)
     {
-        case PORT_ID_A: RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE); break;
-        case PORT_ID_B: RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE); break;
-        case PORT_ID_C: RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOC, ENABLE); break;
-        case PORT_ID_D: RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOD, ENABLE); break;
-        default: return;
+        gpioMode = GPIO_Mode_AIN;
+    }
+    else if (mode == PORT_PIN_MODE_PWM || (mode != PORT_PIN_MODE_DIO && direction == PORT_PIN_OUT))
+    {
+        /* Chân ngoại vi (PWM, TX của SPI/CAN/LIN): Alternate Function push-pull */
+        gpioMode = GPIO_Mode_AF_PP;
+    }
+    else if (direction == PORT_PIN_OUT)
+    {
+        gpioMode = (pinCfg->Pull == PORT_PIN_PULL_UP) ? GPIO_Mode_Out_PP : GPIO_Mode_Out_OD;
+    }
+    else if (pinCfg->Pull == PORT_PIN_PULL_UP)
+    {
+        gpioMode = GPIO_Mode_IPU;
+    }
+    else if (pinCfg->Pull == PORT_PIN_PULL_DOWN)
+    {
+        gpioMode = GPIO_Mode_IPD;
     }
-
-    /* Pin mask */
-    GPIO_InitStruct.GPIO_Pin = pinMask;
-
-    /* Cấu hình tốc độ */
-    if(pinCfg->Speed == SPEED_SMALL)
-        GPIO_InitStruct.GPIO_Speed = GPIO_Speed_2MHz;
-    else if(pinCfg->Speed == SPEED_MEDIUM)
-        GPIO_InitStruct.GPIO_Speed = GPIO_Speed_10MHz;
     else
-        GPIO_InitStruct.GPIO_Speed = GPIO_Speed_50MHz;
-
-    /* Cấu hình mode - DIO */
-    if (pinCfg->Mode == PORT_PIN_MODE_DIO) 
     {
-        if (pinCfg->Direction == PORT_PIN_OUT) 
-        {
-            GPIO_InitStruct.GPIO_Mode = (pinCfg->Pull == PORT_PIN_PULL_UP) ? GPIO_Mode_Out_PP : GPIO_Mode_Out_OD;
-        } 
-        else 
-        {
-            if (pinCfg->Pull == PORT_PIN_PULL_UP)
-                GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IPU;
-            else if (pinCfg->Pull == PORT_PIN_PULL_DOWN)
-                GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IPD;
-            else
-                GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IN_FLOATING;
-        }
+        gpioMode = GPIO_Mode_IN_FLOATING;
     }
 
-    /* Cấu hình mode - ADC */
-    if(pinCfg->Mode == PORT_PIN_MODE_ADC)
+    /* ODR: mức ban đầu của output DIO, hoặc chọn pull-up/pull-down của input */
+    if (gpioMode == GPIO_Mode_Out_PP || gpioMode == GPIO_Mode_Out_OD)
+        *odrLevel = (pinCfg->Level == PORT_PIN_LEVEL_HIGH) ? 1 : 0;
+    else if (gpioMode == GPIO_Mode_IPU)
+        *odrLevel = 1;
+    else if (gpioMode == GPIO_Mode_IPD)
+        *odrLevel = 0;
+    else
+        *odrLevel = -1;
+
+    uint8_t nibble = (uint8_t)(gpioMode & 0x0FU);
+    if (gpioMode & 0x10U) nibble |= (uint8_t)speed;
+    return nibble;
+}
+
+/* Clock APB2 của từng GPIO Port */
+static const uint32_t Port_GpioClock[PORT_NUM_PORTS] = {
+    RCC_APB2Periph_GPIOA, RCC_APB2Periph_GPIOB, RCC_APB2Periph_GPIOC, RCC_APB2Periph_GPIOD
+};
+
+/*
+ * Gom clock ngoại vi mà Mode cần (ADC/PWM) vào mask của từng bus, không gồm clock GPIO
+ */
+static void Port_AddClockMasks(Port_PinModeType mode, uint32_t* apb2, uint32_t* apb1, uint32_t* ahb)
+{
+    if (mode == PORT_PIN_MODE_ADC)
     {
-        GPIO_InitStruct.GPIO_Mode = GPIO_Mode_AIN;
-        RCC_APB2PeriphClockCmd(RCC_APB2Periph_ADC1, ENABLE);
-        RCC_APB2PeriphClockCmd(RCC_APB2Periph_ADC2, ENABLE);
-        RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+        *apb2 |= RCC_APB2Periph_ADC1 | RCC_APB2Periph_ADC2;
+        *ahb  |= RCC_AHBPeriph_DMA1;
     }
-
-    /* Cấu hình mode - PWM */
-    if(pinCfg->Mode == PORT_PIN_MODE_PWM)
+    else if (mode == PORT_PIN_MODE_PWM)
     {
-        GPIO_InitStruct.GPIO_Mode = GPIO_Mode_AF_PP;
-        RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
-        RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3, ENABLE);
-        RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM4, ENABLE);
+        *apb2 |= RCC_APB2Periph_TIM1;
+        *apb1 |= RCC_APB1Periph_TIM2 | RCC_APB1Periph_TIM3 | RCC_APB1Periph_TIM4;
     }
+}
+
+/*
+ * Khóa cấu hình CRL/CRH của các chân trong lockMask bằng chuỗi khóa LCKR
+ * (ghi LCKK=1, LCKK=0, LCKK=1 kèm cùng mask, rồi đọc LCKR hai lần).
+ * Chuỗi không được gián đoạn nên chạy trong vùng tắt ngắt. Khóa giữ đến khi reset.
+ * @return 1 nếu LCKK đọc về 1 (khóa thành công)
+ */
+static uint8_t Port_LockPins(GPIO_TypeDef* gpioPort, uint16_t lockMask)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    gpioPort->LCKR = GPIO_LCKR_LCKK | lockMask;
+    gpioPort->LCKR = lockMask;
+    gpioPort->LCKR = GPIO_LCKR_LCKK | lockMask;
+    (void)gpioPort->LCKR;
+    uint32_t lckr = gpioPort->LCKR;
+    __set_PRIMASK(primask);
 
-    /* Khởi tạo chân */
-    GPIO_TypeDef* gpioPort = PORT_GET_PORT(portNum); 
-    GPIO_Init(gpioPort, &GPIO_InitStruct);
+    return (lckr & GPIO_LCKR_LCKK) ? 1U : 0U;
+}
 
-    /* Nếu là output, set mức ban đầu */
-    if (pinCfg->Direction == PORT_PIN_OUT) {
-        if (pinCfg->Level == PORT_PIN_LEVEL_HIGH)
-            GPIO_SetBits(gpioPort, pinMask);
-        else
-            GPIO_ResetBits(gpioPort, pinMask);
-    }
+/*
+ * Ghi nibble CNF:MODE của 1 pin vào CRL/CRH, chỉ đổi 4 bit của pin đó
+ * ODR ghi trước bằng BSRR (nguyên tử), CRx ghi read-modify-write trong vùng tắt ngắt
+ * để ISR đổi chân khác cùng thanh ghi không bị ghi đè. Ảnh Port_Image cập nhật theo.
+ */
+static void Port_WritePinNibble(Port_PinType Pin, uint8_t nibble, int8_t odrLevel)
+{
+    uint8_t portNum = (uint8_t)PORT_GET_PORT_NUM((uint8_t)Pin);
+    uint8_t pinNum  = (uint8_t)PORT_GET_PIN_NUM((uint8_t)Pin);
+    uint8_t reg     = pinNum >> 3;
+    uint8_t shift   = (uint8_t)((pinNum & 0x07U) * 4U);
+    uint32_t mask   = 0x0FUL << shift;
+
+    GPIO_TypeDef* gpioPort = PORT_GET_PORT(portNum);
+    volatile uint32_t* cr = (reg == 0) ? &gpioPort->CRL : &gpioPort->CRH;
+
+    if (odrLevel == 1)      gpioPort->BSRR = 1UL << pinNum;
+    else if (odrLevel == 0) gpioPort->BSRR = 1UL << (pinNum + 16U);
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *cr = (*cr & ~mask) | ((uint32_t)nibble << shift);
+    Port_Image[portNum].cr[reg] = (Port_Image[portNum].cr[reg] & ~mask) | ((uint32_t)nibble << shift);
+    __set_PRIMASK(primask);
 }
 
 /* ===============================
@@ -134,9 +195,95 @@ void Port_Init(const Port_ConfigType* ConfigPtr)
     if (ConfigPtr == NULL) return;
     Port_ConfigPtr = ConfigPtr;
 
-    for (uint16_t i = 0; i < Port_ConfigPtr->PinCount; i++) {
-        Port_ApplyPinConfig(&Port_ConfigPtr->PinConfigs[i]);
+    uint32_t apb2 = 0, apb1 = 0, ahb = 0;
+
+    for (uint8_t port = 0; port < PORT_NUM_PORTS; port++)
+    {
+        Port_Image[port].cr[0] = 0;
+        Port_Image[port].cr[1] = 0;
+        Port_Image[port].crMask[0] = 0;
+        Port_Image[port].crMask[1] = 0;
+        Port_Image[port].refreshMask[0] = 0;
+        Port_Image[port].refreshMask[1] = 0;
+        Port_Image[port].bsrr = 0;
+        Port_Image[port].pinMask = 0;
+        Port_Image[port].lockMask = 0;
+    }
+
+    for (uint8_t pin = 0; pin < PORT_NUM_PINS; pin++)
+    {
+        Port_PinIndex[pin] = PORT_NO_INDEX;
+    }
+
+    /* Gom cấu hình tất cả pin vào ảnh CRL/CRH/ODR của từng Port */
+    for (uint16_t i = 0; i < Port_ConfigPtr->PinCount; i++)
+    {
+        const Port_PinConfigType* pinCfg = &Port_ConfigPtr->PinConfigs[i];
+        uint8_t portNum = (uint8_t)PORT_GET_PORT_NUM((uint8_t)pinCfg->Pin);
+        uint8_t pinNum  = (uint8_t)PORT_GET_PIN_NUM((uint8_t)pinCfg->Pin);
+        if (portNum >= PORT_NUM_PORTS) continue;
+
+        /* Bảng index 1 byte/pin (PinConfigs tối đa 255 phần tử), pin trùng lặp giữ cấu hình đầu tiên */
+        if (i < PORT_NO_INDEX && Port_PinIndex[(uint8_t)pinCfg->Pin] == PORT_NO_INDEX)
+        {
+            Port_PinIndex[(uint8_t)pinCfg->Pin] = (uint8_t)i;
+        }
+
+        Port_ImageType* img = &Port_Image[portNum];
+        int8_t odrLevel;
+        uint8_t nibble = Port_CalcPinNibble(pinCfg, pinCfg->Mode, pinCfg->Direction, &odrLevel);
+        uint8_t reg   = pinNum >> 3;
+        uint8_t shift = (uint8_t)((pinNum & 0x07U) * 4U);
+
+        img->cr[reg]     = (img->cr[reg] & ~(0x0FUL << shift)) | ((uint32_t)nibble << shift);
+        img->crMask[reg] |= 0x0FUL << shift;
+        if (!pinCfg->DirectionChangeable) img->refreshMask[reg] |= 0x0FUL << shift;
+        if (!pinCfg->DirectionChangeable && !pinCfg->ModeChangeable) img->lockMask |= (uint16_t)(1U << pinNum);
+        img->pinMask     |= (uint16_t)(1U << pinNum);
+
+        img->bsrr &= ~((0x10001UL) << pinNum);
+        if (odrLevel == 1)      img->bsrr |= 1UL << pinNum;
+        else if (odrLevel == 0) img->bsrr |= 1UL << (pinNum + 16U);
+
+        apb2 |= Port_GpioClock[portNum];
+        Port_AddClockMasks(pinCfg->Mode, &apb2, &apb1, &ahb);
+    }
+
+    /* Mỗi bus một lần ghi RCC */
+    RCC->AHBENR  |= ahb;
+    RCC->APB1ENR |= apb1;
+    RCC->APB2ENR |= apb2;
+
+    /* Mỗi Port: ODR trước (output lên đúng mức ngay khi đổi mode), rồi CRL/CRH mỗi thanh ghi một lần ghi */
+    for (uint8_t port = 0; port < PORT_NUM_PORTS; port++)
+    {
+        const Port_ImageType* img = &Port_Image[port];
+        if (img->pinMask == 0) continue;
+
+        GPIO_TypeDef* gpioPort = PORT_GET_PORT(port);
+        gpioPort->BSRR = img->bsrr;
+        if (img->crMask[0]) gpioPort->CRL = (gpioPort->CRL & ~img->crMask[0]) | img->cr[0];
+        if (img->crMask[1]) gpioPort->CRH = (gpioPort->CRH & ~img->crMask[1]) | img->cr[1];
+    }
+
+    /* Khóa phần cứng các chân cố định; chân đã khóa không thể lệch nên Refresh bỏ qua */
+    for (uint8_t port = 0; port < PORT_NUM_PORTS; port++)
+    {
+        Port_ImageType* img = &Port_Image[port];
+        if (img->lockMask == 0) continue;
+
+        if (Port_LockPins(PORT_GET_PORT(port), img->lockMask))
+        {
+            for (uint8_t pin = 0; pin < 16U; pin++)
+            {
+                if (img->lockMask & (1U << pin))
+                {
+                    img->refreshMask[pin >> 3] &= ~(0x0FUL << ((pin & 0x07U) * 4U));
+                }
+            }
+        }
     }
+
     Port_Initialized = 1;
 }
 
@@ -144,41 +291,92 @@ void Port_SetPinDirection(Port_PinType Pin, Port_PinDirectionType Direction)
 {
     if (!Port_Initialized || Port_ConfigPtr == NULL) return;
 
-    sint16 index = Port_FindPinIndex(Pin);
-    if (index == -1) return;  /* Pin không có trong config */
+    uint8_t index = Port_FindPinIndex(Pin);
+    if (index == PORT_NO_INDEX) return;  /* Pin không có trong config */
 
-    if (!Port_ConfigPtr->PinConfigs[index].DirectionChangeable) return;
+    const Port_PinConfigType* pinCfg = &Port_ConfigPtr->PinConfigs[index];
+    if (!pinCfg->DirectionChangeable) return;
 
-    Port_PinConfigType pinCfgTemp = Port_ConfigPtr->PinConfigs[index];
-    pinCfgTemp.Direction = Direction;
-    Port_ApplyPinConfig(&pinCfgTemp);
+    /* Clock đã bật trong Port_Init, chỉ cần vá nibble của pin */
+    int8_t odrLevel;
+    uint8_t nibble = Port_CalcPinNibble(pinCfg, pinCfg->Mode, Direction, &odrLevel);
+    Port_WritePinNibble(Pin, nibble, odrLevel);
 }
 
 void Port_SetPinMode(Port_PinType Pin, Port_PinModeType Mode) 
 {
     if (!Port_Initialized || Port_ConfigPtr == NULL) return;
 
-    sint16 index = Port_FindPinIndex(Pin);
-    if (index == -1) return;
+    uint8_t index = Port_FindPinIndex(Pin);
+    if (index == PORT_NO_INDEX) return;
 
-    if (!Port_ConfigPtr->PinConfigs[index].ModeChangeable) return;
+    const Port_PinConfigType* pinCfg = &Port_ConfigPtr->PinConfigs[index];
+    if (!pinCfg->ModeChangeable) return;
 
-    Port_PinConfigType pinCfgTemp = Port_ConfigPtr->PinConfigs[index];
-    pinCfgTemp.Mode = Mode;
-    Port_ApplyPinConfig(&pinCfgTemp);
+    /* Clock GPIO đã bật trong Port_Init. Chỉ ghi RCC khi mode mới cần clock ngoại vi
+     * (ADC/PWM) chưa bật, còn lại chỉ vá nibble của pin */
+    uint32_t apb2 = 0, apb1 = 0, ahb = 0;
+    Port_AddClockMasks(Mode, &apb2, &apb1, &ahb);
+    if (ahb  & ~RCC->AHBENR)  RCC->AHBENR  |= ahb;
+    if (apb1 & ~RCC->APB1ENR) RCC->APB1ENR |= apb1;
+    if (apb2 & ~RCC->APB2ENR) RCC->APB2ENR |= apb2;
+
+    int8_t odrLevel;
+    uint8_t nibble = Port_CalcPinNibble(pinCfg, Mode, pinCfg->Direction, &odrLevel);
+    Port_WritePinNibble(Pin, nibble, odrLevel);
 }
 
 void Port_RefreshPortDirection(void) 
 {
     if (!Port_Initialized || Port_ConfigPtr == NULL) return;
 
-    for (uint16_t i = 0; i < Port_ConfigPtr->PinCount; i++) {
-        if (!Port_ConfigPtr->PinConfigs[i].DirectionChangeable) {
-            Port_ApplyPinConfig(&Port_ConfigPtr->PinConfigs[i]);
+    for (uint8_t port = 0; port < PORT_NUM_PORTS; port++)
+    {
+        const Port_ImageType* img = &Port_Image[port];
+        if ((img->refreshMask[0] | img->refreshMask[1]) == 0) continue;
+
+        GPIO_TypeDef* gpioPort = PORT_GET_PORT(port);
+
+        for (uint8_t reg = 0; reg < 2; reg++)
+        {
+            volatile uint32_t* cr = (reg == 0) ? &gpioPort->CRL : &gpioPort->CRH;
+
+            /* So ảnh mong muốn với thanh ghi thật, chỉ trên nibble của chân cần giữ chiều */
+            uint32_t diff = (*cr ^ img->cr[reg]) & img->refreshMask[reg];
+            if (diff == 0) continue;
+
+            /* Nibble có bit lệch -> bit 0 của nibble -> mask cả nibble */
+            uint32_t drifted = (diff | (diff >> 1) | (diff >> 2) | (diff >> 3)) & 0x11111111UL;
+            uint32_t nibbleMask = drifted * 0x0FUL;
+
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            *cr = (*cr & ~nibbleMask) | (img->cr[reg] & nibbleMask);
+            __set_PRIMASK(primask);
+
+            while (drifted)
+            {
+                drifted &= drifted - 1U;
+                Port_RefreshCorrections++;
+            }
         }
     }
 }
 
+uint16_t Port_GetLockedPins(uint8_t PortNum)
+{
+    if (PortNum >= PORT_NUM_PORTS) return 0;
+
+    /* LCKK = 1: khóa đang hiệu lực, LCK[15:0] là các chân bị khóa */
+    uint32_t lckr = PORT_GET_PORT(PortNum)->LCKR;
+    return (lckr & GPIO_LCKR_LCKK) ? (uint16_t)(lckr & 0xFFFFU) : 0U;
+}
+
+uint32_t Port_GetRefreshCorrectionCount(void)
+{
+    return Port_RefreshCorrections;
+}
+
 void Port_GetVersionInfo(Std_VersionInfoType* versioninfo) 
 {
     if (versioninfo == NULL) return;
@@ -202,9 +202,24 @@ void Port_SetPinDirection(Port_PinType Pin, Port_PinDirectionType Direction);
 
 /**
  * @brief   Làm tươi lại chiều tất cả các pin không cho đổi chiều runtime
+ * @details So CRL/CRH thật với ảnh dựng trong Port_Init, chỉ ghi lại nibble bị lệch
  */
 void Port_RefreshPortDirection(void);
 
+/**
+ * @brief   Số nibble cấu hình bị lệch đã được Port_RefreshPortDirection sửa từ lúc khởi động
+ */
+uint32_t Port_GetRefreshCorrectionCount(void);
+
+/**
+ * @brief   Đọc các chân của Port đang bị khóa cấu hình bằng LCKR
+ * @details Port_Init khóa các chân có DirectionChangeable = 0 và ModeChangeable = 0,
+ *          khóa chỉ mất khi reset MCU
+ * @param[in] PortNum  PORT_ID_A .. PORT_ID_D
+ * @return  Mask chân bị khóa (bit n = chân n), 0 nếu Port chưa khóa
+ */
+uint16_t Port_GetLockedPins(uint8_t PortNum);
+
 /**
  * @brief   Lấy thông tin version của Port Driver
  * @param[out] versioninfo  Con trỏ tới cấu trúc Std_VersionInfoType để nhận version
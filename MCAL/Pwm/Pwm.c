@@ -10,7 +10,7 @@
  **********************************************************/
 
 #include "Pwm.h"
-#include "IoHwAb_Cfg.h"
+#include "stm32f10x_rcc.h"
 
 /* ===============================
  *     Static Variables & Defines
@@ -22,6 +22,690 @@ static const Pwm_ConfigType* Pwm_CurrentConfigPtr = NULL;
 /* Trạng thái đã khởi tạo của driver PWM */
 static uint8 Pwm_IsInitialized = 0;
 
+/* Kênh CCx của Timer chưa gán cho kênh PWM nào */
+#define PWM_NO_CHANNEL      ((Pwm_ChannelType)0xFF)
+
+/* Mask các cờ CC1..CC4 trong thanh ghi SR/DIER */
+#define PWM_SR_CC_MASK      ((uint16_t)(TIM_IT_CC1 | TIM_IT_CC2 | TIM_IT_CC3 | TIM_IT_CC4))
+
+/* Số chu kỳ clock Timer tối thiểu giữa hai cạnh của kênh shifted (đủ cho ISR ghi lại CCR) */
+#define PWM_SHIFT_MIN_CYCLES    256U
+
+/*
+ * Bản ghi runtime cho từng Timer, được dựng một lần trong Pwm_Init
+ * ISR chỉ cần đọc SR một lần rồi tra bảng này, không duyệt lại cấu hình kênh
+ */
+typedef struct {
+    TIM_TypeDef*    TIMx;           /* Timer tương ứng (NULL nếu không dùng) */
+    uint8_t         notifyMask;     /* Bit n = 1: kênh gắn với CC(n+1) được cấu hình notification */
+    uint8_t         notifyRiseMask; /* Bit n = 1: kênh CC(n+1) đang yêu cầu thông báo cạnh lên */
+    uint8_t         notifyFallMask; /* Bit n = 1: kênh CC(n+1) đang yêu cầu thông báo cạnh xuống */
+    uint8_t         lowPolarityMask;/* Bit n = 1: kênh CC(n+1) polarity thấp (đảo cạnh update/CC) */
+    uint8_t         steadyMask;     /* Bit n = 1: kênh CC(n+1) đang ở 0% / 100% / idle, không có cạnh */
+    uint8_t         idleMask;       /* Bit n = 1: kênh CC(n+1) đã Pwm_SetOutputToIdle, không ghi lại CCR */
+    uint8_t         ditherMask;     /* Bit n = 1: kênh gắn với CC(n+1) bật dithering */
+    Pwm_ChannelType ccChannel[4];   /* CC1..CC4 -> ID kênh PWM (index trong Channels) */
+    void (*NotificationCb)(uint8);  /* Callback thông báo của Timer */
+    volatile uint32_t ditherTarget[4]; /* Giá trị compare mong muốn dạng Q15: (ARR + 1) * duty */
+    uint16_t          ditherAcc[4];    /* Bộ tích lũy sai số phần lẻ (sigma-delta) */
+    uint16_t          duty[4];         /* Duty cycle đang đặt cho CC1..CC4 (0x0000 - 0x8000) */
+    uint8_t           shiftMask;       /* Bit n = 1: kênh CC(n+1) là PWM_FIXED_PERIOD_SHIFTED */
+    uint8_t           shiftActive;     /* Bit n = 1: kênh shifted đang chạy Toggle mode (chỉ main ghi) */
+    uint8_t           shiftLevel[4];   /* Mức OCxREF hiện tại của kênh shifted (chỉ ISR ghi khi active) */
+    volatile uint32_t shiftEdges[4];   /* Tick cạnh xuống << 16 | tick cạnh lên */
+    uint8_t           centerAligned;   /* 1: Timer đếm center-aligned (chu kỳ = 2 x ARR) */
+    uint8_t           counterMode;     /* Pwm_CounterModeType của Timer (chọn chiều báo cờ CCx) */
+    uint8_t           spreadPercent;   /* Spread-spectrum: biên độ ±% ARR, 0 = tắt */
+    uint8_t           spreadRandom;    /* 1: ARR giả ngẫu nhiên (LFSR), 0: tam giác */
+    uint16_t          spreadNominal;   /* ARR danh định (trước khi dao động) */
+    int32_t           spreadOffset;    /* Độ lệch ARR hiện tại so với danh định */
+    int32_t           spreadDir;       /* Chiều quét tam giác: +1 / -1 */
+    uint16_t          spreadLfsr;      /* Trạng thái LFSR 16 bit */
+    uint32_t          clockHz;         /* Clock cấp cho Timer (trước prescaler) */
+    uint32_t          frequencyHz;     /* Tần số PWM thực tế đạt được */
+} Pwm_TimerDispatchType;
+
+static Pwm_TimerDispatchType Pwm_TimerDispatch[PWM_NUM_TIMERS];
+
+/* ===============================
+ *      Internal Helper Function
+ * =============================== */
+
+/*
+ * Ánh xạ địa chỉ Timer sang index trong bảng dispatch
+ * @return index 0..PWM_NUM_TIMERS-1, PWM_NUM_TIMERS nếu không hỗ trợ
+ */
+static inline uint8_t Pwm_GetTimerIndex(const TIM_TypeDef* TIMx)
+{
+    if (TIMx == TIM2) return 0;
+    if (TIMx == TIM3) return 1;
+    if (TIMx == TIM4) return 2;
+    if (TIMx == TIM1) return 3;
+    return PWM_NUM_TIMERS;
+}
+
+/*
+ * Bảng ITR cho chế độ slave (RM0008, bảng Internal trigger connection)
+ * [slave][master] theo index dispatch: TIM2, TIM3, TIM4, TIM1
+ * 0xFFFF: master trùng slave
+ */
+static const uint16_t Pwm_ItrTable[PWM_NUM_TIMERS][PWM_NUM_TIMERS] = {
+    /* master:   TIM2         TIM3         TIM4         TIM1      */
+    /* TIM2 */ { 0xFFFF,      TIM_TS_ITR2, TIM_TS_ITR3, TIM_TS_ITR0 },
+    /* TIM3 */ { TIM_TS_ITR1, 0xFFFF,      TIM_TS_ITR3, TIM_TS_ITR0 },
+    /* TIM4 */ { TIM_TS_ITR1, TIM_TS_ITR2, 0xFFFF,      TIM_TS_ITR0 },
+    /* TIM1 */ { TIM_TS_ITR1, TIM_TS_ITR2, TIM_TS_ITR3, 0xFFFF      }
+};
+
+/*
+ * Tần số clock cấp cho Timer (Hz)
+ * Theo RM0008: nếu prescaler APB khác 1 thì clock Timer = 2 x PCLK
+ */
+static uint32_t Pwm_GetTimerClock(const TIM_TypeDef* TIMx)
+{
+    RCC_ClocksTypeDef clocks;
+    RCC_GetClocksFreq(&clocks);
+
+    uint32_t pclk = (TIMx == TIM1) ? clocks.PCLK2_Frequency : clocks.PCLK1_Frequency;
+    return (pclk == clocks.HCLK_Frequency) ? pclk : (pclk * 2U);
+}
+
+/*
+ * Mã hóa dead-time (ns) sang trường DTG của BDTR, làm tròn lên để dead-time
+ * thực tế không bao giờ ngắn hơn cấu hình (tDTS = clock Timer, CKD = DIV1)
+ *   DTG[7:5] = 0xx: DT = DTG[6:0]             x tDTS   (0..127)
+ *   DTG[7:5] = 10x: DT = (64 + DTG[5:0]) x 2  x tDTS   (128..254)
+ *   DTG[7:5] = 110: DT = (32 + DTG[4:0]) x 8  x tDTS   (256..504)
+ *   DTG[7:5] = 111: DT = (32 + DTG[4:0]) x 16 x tDTS   (512..1008)
+ */
+static uint8_t Pwm_CalcDeadTime(uint32_t timerClockHz, uint16_t deadTimeNs)
+{
+    uint32_t clockMHz = timerClockHz / 1000000U;
+    uint32_t ticks = (clockMHz * deadTimeNs + 999U) / 1000U;
+
+    if (ticks <= 127U)  return (uint8_t)ticks;
+    if (ticks <= 254U)  return (uint8_t)(0x80U | (((ticks + 1U) / 2U) - 64U));
+    if (ticks <= 504U)  return (uint8_t)(0xC0U | (((ticks + 7U) / 8U) - 32U));
+    if (ticks <= 1008U) return (uint8_t)(0xE0U | (((ticks + 15U) / 16U) - 32U));
+    return 0xFFU;   /* Dead-time tối đa */
+}
+
+/*
+ * Cấu hình BDTR cho TIM1 (dead-time, Break) và bật Main Output
+ */
+static void Pwm_InitAdvancedTimer(const Pwm_AdvancedTimerConfigType* advCfg)
+{
+    TIM_BDTRInitTypeDef bdtr;
+    TIM_BDTRStructInit(&bdtr);
+
+    /* OSSR/OSSI = 1: khi tắt output hoặc Break, chân giữ mức idle thay vì thả nổi */
+    bdtr.TIM_OSSRState = TIM_OSSRState_Enable;
+    bdtr.TIM_OSSIState = TIM_OSSIState_Enable;
+    bdtr.TIM_LOCKLevel = TIM_LOCKLevel_OFF;
+
+    if (advCfg != NULL)
+    {
+        bdtr.TIM_DeadTime = Pwm_CalcDeadTime(Pwm_GetTimerClock(TIM1), advCfg->deadTimeNs);
+        bdtr.TIM_Break = advCfg->breakEnable ? TIM_Break_Enable : TIM_Break_Disable;
+        bdtr.TIM_BreakPolarity = (advCfg->breakPolarity == PWM_HIGH) ? TIM_BreakPolarity_High : TIM_BreakPolarity_Low;
+        bdtr.TIM_AutomaticOutput = advCfg->automaticOutput ? TIM_AutomaticOutput_Enable : TIM_AutomaticOutput_Disable;
+    }
+
+    TIM_BDTRConfig(TIM1, &bdtr);
+
+    /* Xóa cờ Break cũ rồi bật MOE */
+    TIM_ClearFlag(TIM1, TIM_FLAG_Break);
+    TIM_CtrlPWMOutputs(TIM1, ENABLE);
+}
+
+/*
+ * Tìm cấu hình riêng của Timer trong Pwm_ConfigType
+ * @return NULL nếu Timer không có cấu hình riêng (mặc định edge-aligned)
+ */
+static const Pwm_TimerConfigType* Pwm_FindTimerConfig(const Pwm_ConfigType* ConfigPtr, const TIM_TypeDef* TIMx)
+{
+    if (ConfigPtr->Timers == NULL) return NULL;
+
+    for (uint8_t i = 0; i < ConfigPtr->NumTimers; i++)
+    {
+        if (ConfigPtr->Timers[i].TIMx == TIMx) return &ConfigPtr->Timers[i];
+    }
+    return NULL;
+}
+
+/*
+ * Dựng bảng dispatch ngắt cho từng Timer từ cấu hình kênh
+ */
+static void Pwm_BuildDispatch(const Pwm_ConfigType* ConfigPtr)
+{
+    for (uint8_t t = 0; t < PWM_NUM_TIMERS; t++)
+    {
+        Pwm_TimerDispatch[t].TIMx = NULL;
+        Pwm_TimerDispatch[t].notifyMask = 0;
+        Pwm_TimerDispatch[t].notifyRiseMask = 0;
+        Pwm_TimerDispatch[t].notifyFallMask = 0;
+        Pwm_TimerDispatch[t].lowPolarityMask = 0;
+        Pwm_TimerDispatch[t].steadyMask = 0;
+        Pwm_TimerDispatch[t].idleMask = 0;
+        Pwm_TimerDispatch[t].ditherMask = 0;
+        Pwm_TimerDispatch[t].NotificationCb = ConfigPtr->NotificationCb;
+        for (uint8_t cc = 0; cc < 4; cc++)
+        {
+            Pwm_TimerDispatch[t].ccChannel[cc] = PWM_NO_CHANNEL;
+            Pwm_TimerDispatch[t].ditherTarget[cc] = 0;
+            Pwm_TimerDispatch[t].ditherAcc[cc] = 0;
+            Pwm_TimerDispatch[t].duty[cc] = 0;
+            Pwm_TimerDispatch[t].shiftLevel[cc] = 0;
+            Pwm_TimerDispatch[t].shiftEdges[cc] = 0;
+        }
+        Pwm_TimerDispatch[t].shiftMask = 0;
+        Pwm_TimerDispatch[t].shiftActive = 0;
+        Pwm_TimerDispatch[t].centerAligned = 0;
+        Pwm_TimerDispatch[t].counterMode = PWM_COUNTER_EDGE_ALIGNED;
+        Pwm_TimerDispatch[t].spreadPercent = 0;
+        Pwm_TimerDispatch[t].spreadRandom = 0;
+        Pwm_TimerDispatch[t].spreadNominal = 0;
+        Pwm_TimerDispatch[t].spreadOffset = 0;
+        Pwm_TimerDispatch[t].spreadDir = 1;
+        Pwm_TimerDispatch[t].spreadLfsr = 0xACE1U;
+        Pwm_TimerDispatch[t].clockHz = 0;
+        Pwm_TimerDispatch[t].frequencyHz = 0;
+    }
+
+    for (uint8_t i = 0; i < ConfigPtr->NumChannels; i++)
+    {
+        const Pwm_ChannelConfigType* cfg = &ConfigPtr->Channels[i];
+        uint8_t t = Pwm_GetTimerIndex(cfg->TIMx);
+
+        if (t >= PWM_NUM_TIMERS || cfg->channel < 1 || cfg->channel > 4) continue;
+
+        const Pwm_TimerConfigType* timerCfg = Pwm_FindTimerConfig(ConfigPtr, cfg->TIMx);
+
+        Pwm_TimerDispatch[t].TIMx = cfg->TIMx;
+        Pwm_TimerDispatch[t].counterMode = (timerCfg != NULL) ? (uint8_t)timerCfg->counterMode : PWM_COUNTER_EDGE_ALIGNED;
+        Pwm_TimerDispatch[t].centerAligned = (Pwm_TimerDispatch[t].counterMode != PWM_COUNTER_EDGE_ALIGNED);
+        if (timerCfg != NULL && timerCfg->spreadPercent > 0)
+        {
+            Pwm_TimerDispatch[t].spreadPercent = (timerCfg->spreadPercent > 50) ? 50U : (uint8_t)timerCfg->spreadPercent;
+            Pwm_TimerDispatch[t].spreadRandom = (timerCfg->spreadProfile == PWM_SPREAD_RANDOM);
+        }
+        Pwm_TimerDispatch[t].ccChannel[cfg->channel - 1] = i;
+        if (cfg->notificationEnable)
+        {
+            Pwm_TimerDispatch[t].notifyMask |= (uint8_t)(1U << (cfg->channel - 1));
+        }
+        if (cfg->polarity == PWM_LOW)
+        {
+            Pwm_TimerDispatch[t].lowPolarityMask |= (uint8_t)(1U << (cfg->channel - 1));
+        }
+        if (cfg->classType == PWM_FIXED_PERIOD_SHIFTED && !Pwm_TimerDispatch[t].centerAligned)
+        {
+            /* Kênh shifted tự điều khiển CCR trong ISR, không kết hợp với dithering
+             * Center-aligned có hai lần match mỗi chu kỳ nên kênh shifted chạy như PWM thường */
+            Pwm_TimerDispatch[t].shiftMask |= (uint8_t)(1U << (cfg->channel - 1));
+        }
+        else if (cfg->ditherEnable)
+        {
+            Pwm_TimerDispatch[t].ditherMask |= (uint8_t)(1U << (cfg->channel - 1));
+        }
+    }
+
+    /* Kênh shifted dùng tick tuyệt đối của ARR nên Timer có kênh shifted không dao động tần số */
+    for (uint8_t t = 0; t < PWM_NUM_TIMERS; t++)
+    {
+        if (Pwm_TimerDispatch[t].shiftMask) Pwm_TimerDispatch[t].spreadPercent = 0;
+    }
+}
+
+/*
+ * Tính giá trị compare dạng Q15 từ duty cycle (0x0000 - 0x8000)
+ * Edge-aligned, PWM mode 1: tỉ lệ mức cao = CCR / (ARR + 1), nên 0x8000 -> CCR = ARR + 1 (100%)
+ * Center-aligned: đếm lên ARR rồi xuống 0, tỉ lệ mức cao = CCR / ARR; 100% cần CCR > ARR
+ * 15 bit thấp là phần lẻ, dùng cho dithering
+ */
+static inline uint32_t Pwm_CalcCompareQ15(uint16_t arr, uint16_t DutyCycle, uint8_t centerAligned)
+{
+    if (DutyCycle >= 0x8000U) return ((uint32_t)arr + 1U) << 15;
+    return ((uint32_t)arr + (centerAligned ? 0U : 1U)) * DutyCycle;
+}
+
+/*
+ * Lấy phần nguyên của giá trị compare Q15, giới hạn trong 16 bit của CCR
+ */
+static inline uint16_t Pwm_CompareFromQ15(uint32_t compareQ15)
+{
+    uint32_t compareValue = compareQ15 >> 15;
+    return (compareValue > 0xFFFFU) ? (uint16_t)0xFFFFU : (uint16_t)compareValue;
+}
+
+/*
+ * Ghi giá trị compare vào CCRx tương ứng với channel (1..4)
+ */
+static inline void Pwm_WriteCompare(TIM_TypeDef* TIMx, Pwm_ChannelType channel, uint16_t compareValue)
+{
+    switch (channel) {
+    case 1: TIMx->CCR1 = compareValue; break;
+    case 2: TIMx->CCR2 = compareValue; break;
+    case 3: TIMx->CCR3 = compareValue; break;
+    case 4: TIMx->CCR4 = compareValue; break;
+    default: break;
+    }
+}
+
+/*
+ * Lưu duty của kênh vào bản ghi Timer, nếu kênh bật dithering thì lưu
+ * giá trị Q15 để ISR update phân bổ phần lẻ qua các chu kỳ
+ * @return Giá trị compare dạng Q15
+ */
+static uint32_t Pwm_StoreDuty(const Pwm_ChannelConfigType* channelConfig, uint16_t arr, uint16_t DutyCycle)
+{
+    uint8_t t = Pwm_GetTimerIndex(channelConfig->TIMx);
+    if (t >= PWM_NUM_TIMERS) return Pwm_CalcCompareQ15(arr, DutyCycle, 0);
+
+    uint32_t compareQ15 = Pwm_CalcCompareQ15(arr, DutyCycle, Pwm_TimerDispatch[t].centerAligned);
+
+    if (channelConfig->channel >= 1 && channelConfig->channel <= 4)
+    {
+        uint8_t bit = (uint8_t)(1U << (channelConfig->channel - 1));
+        Pwm_TimerDispatch[t].duty[channelConfig->channel - 1] = DutyCycle;
+
+        /* 0% / 100%: ngõ ra không đổi mức, ISR bỏ qua thông báo cạnh của kênh */
+        if (DutyCycle == 0 || DutyCycle >= 0x8000U) Pwm_TimerDispatch[t].steadyMask |= bit;
+        else Pwm_TimerDispatch[t].steadyMask &= (uint8_t)~bit;
+        if (channelConfig->ditherEnable)
+        {
+            /* Ghi 32 bit một lần, ISR luôn đọc được giá trị nhất quán */
+            Pwm_TimerDispatch[t].ditherTarget[channelConfig->channel - 1] = compareQ15;
+        }
+    }
+    return compareQ15;
+}
+
+/*
+ * Đặt trường OCxM (mode output compare) của channel (1..4), không đụng tới CCxE
+ */
+static inline void Pwm_SetOcMode(TIM_TypeDef* TIMx, Pwm_ChannelType channel, uint16_t ocMode)
+{
+    volatile uint16_t* ccmr = (channel <= 2) ? &TIMx->CCMR1 : &TIMx->CCMR2;
+    uint8_t shift = (channel % 2 == 0) ? 8U : 0U;
+    *ccmr = (uint16_t)((*ccmr & ~(TIM_CCMR1_OC1M << shift)) | (ocMode << shift));
+}
+
+/*
+ * Kênh PWM_FIXED_PERIOD_SHIFTED: mức cao từ tick phase tới phase + duty (mod chu kỳ)
+ * Chạy Toggle mode, ISR CCx luân phiên ghi CCR = cạnh xuống / cạnh lên.
+ * Duty quá gần 0% hoặc 100% (ISR không kịp ghi CCR) dùng Forced Inactive / Active.
+ */
+static void Pwm_ApplyShiftedDuty(const Pwm_ChannelConfigType* channelConfig, uint8_t t, uint16_t arr, uint16_t DutyCycle)
+{
+    Pwm_TimerDispatchType* timer = &Pwm_TimerDispatch[t];
+    TIM_TypeDef* TIMx = channelConfig->TIMx;
+    uint8_t cc = (uint8_t)(channelConfig->channel - 1);
+    uint8_t bit = (uint8_t)(1U << cc);
+
+    uint32_t periodTicks = (uint32_t)arr + 1U;
+    uint32_t minTicks = (PWM_SHIFT_MIN_CYCLES / ((uint32_t)TIMx->PSC + 1U)) + 1U;
+    uint32_t dutyTicks = Pwm_CompareFromQ15(Pwm_CalcCompareQ15(arr, DutyCycle, 0));
+
+    if (dutyTicks < minTicks || dutyTicks + minTicks > periodTicks)
+    {
+        timer->shiftActive &= (uint8_t)~bit;
+        Pwm_SetOcMode(TIMx, channelConfig->channel,
+                      (dutyTicks < minTicks) ? TIM_ForcedAction_InActive : TIM_ForcedAction_Active);
+        return;
+    }
+
+    uint32_t rise = Pwm_CompareFromQ15(Pwm_CalcCompareQ15(arr, (uint16_t)channelConfig->phaseShift, 0)) % periodTicks;
+    uint32_t fall = (rise + dutyTicks) % periodTicks;
+
+    /* Ghi 32 bit một lần, ISR luôn đọc được cặp cạnh nhất quán */
+    timer->shiftEdges[cc] = (fall << 16) | rise;
+
+    if (!(timer->shiftActive & bit))
+    {
+        /* Từ Forced/PWM sang Toggle: OCxREF về thấp, cạnh kế tiếp là cạnh lên */
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        Pwm_SetOcMode(TIMx, channelConfig->channel, TIM_ForcedAction_InActive);
+        timer->shiftLevel[cc] = 0;
+        Pwm_WriteCompare(TIMx, channelConfig->channel, (uint16_t)rise);
+        TIMx->SR = (uint16_t)~(TIM_IT_CC1 << cc);
+        Pwm_SetOcMode(TIMx, channelConfig->channel, TIM_OCMode_Toggle);
+        timer->shiftActive |= bit;
+        __set_PRIMASK(primask);
+    }
+}
+
+/*
+ * Cập nhật duty cho kênh: lưu trạng thái và ghi CCR ngay
+ */
+static void Pwm_ApplyDuty(const Pwm_ChannelConfigType* channelConfig, uint16_t arr, uint16_t DutyCycle)
+{
+    uint32_t compareQ15 = Pwm_StoreDuty(channelConfig, arr, DutyCycle);
+    uint8_t t = Pwm_GetTimerIndex(channelConfig->TIMx);
+
+    if (t < PWM_NUM_TIMERS && (Pwm_TimerDispatch[t].shiftMask & (1U << (channelConfig->channel - 1))))
+    {
+        Pwm_ApplyShiftedDuty(channelConfig, t, arr, DutyCycle);
+        return;
+    }
+
+    Pwm_WriteCompare(channelConfig->TIMx, channelConfig->channel, Pwm_CompareFromQ15(compareQ15));
+}
+
+/*
+ * Kênh đang idle nhận duty mới: bỏ bit idle và trả OCxM về PWM1
+ * (Pwm_SetOutputToIdle chỉ đổi OCxM sang Forced, CCER/CR2 giữ nguyên cấu hình).
+ * Kênh shifted để Pwm_ApplyShiftedDuty tự chuyển Forced -> Toggle.
+ */
+static void Pwm_LeaveIdle(const Pwm_ChannelConfigType* channelConfig, uint8_t t)
+{
+    uint8_t cc = (uint8_t)(channelConfig->channel - 1);
+    if (!(Pwm_TimerDispatch[t].idleMask & (1U << cc))) return;
+
+    if (!(Pwm_TimerDispatch[t].shiftMask & (1U << cc)))
+    {
+        Pwm_SetOcMode(channelConfig->TIMx, channelConfig->channel, TIM_OCMode_PWM1);
+    }
+
+    Pwm_TimerDispatch[t].idleMask &= (uint8_t)~(1U << cc);
+}
+
+/*
+ * Bật một đường ngắt NVIC
+ */
+static void Pwm_EnableIrqLine(IRQn_Type irq)
+{
+    NVIC_InitTypeDef nvic;
+    nvic.NVIC_IRQChannel = (uint8_t)irq;
+    nvic.NVIC_IRQChannelPreemptionPriority = 0;
+    nvic.NVIC_IRQChannelSubPriority = 0;
+    nvic.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&nvic);
+}
+
+/*
+ * Bật NVIC cho ngắt của Timer (TIM1 có vector Update và CC riêng)
+ */
+static void Pwm_EnableTimerIrq(const TIM_TypeDef* TIMx)
+{
+    if (TIMx == TIM1)
+    {
+        Pwm_EnableIrqLine(TIM1_UP_IRQn);
+        Pwm_EnableIrqLine(TIM1_CC_IRQn);
+    }
+    else if (TIMx == TIM2) Pwm_EnableIrqLine(TIM2_IRQn);
+    else if (TIMx == TIM3) Pwm_EnableIrqLine(TIM3_IRQn);
+    else if (TIMx == TIM4) Pwm_EnableIrqLine(TIM4_IRQn);
+}
+
+/*
+ * Tính lại các bit UIE/CCxIE của Timer từ nhu cầu hiện tại:
+ * spread/dithering cần update, kênh shifted cần CCx, thông báo cạnh cần update hoặc CCx.
+ * Edge-aligned PWM1 polarity cao: cạnh lên tại update, cạnh xuống tại CCx (polarity thấp thì ngược lại).
+ * Center-aligned: cạnh đều tại CCx. Mode 1 chỉ báo cờ khi đếm xuống (chỉ có cạnh lên),
+ * mode 2 chỉ khi đếm lên (chỉ có cạnh xuống), mode 3 báo cả hai cạnh.
+ * Chỉ gọi từ main, ISR không ghi DIER.
+ */
+static void Pwm_UpdateTimerIrq(uint8_t t)
+{
+    Pwm_TimerDispatchType* timer = &Pwm_TimerDispatch[t];
+    TIM_TypeDef* TIMx = timer->TIMx;
+    if (TIMx == NULL) return;
+
+    uint8_t low = timer->lowPolarityMask;
+    uint8_t updSlots = (uint8_t)((timer->notifyRiseMask & ~low) | (timer->notifyFallMask & low));
+    uint8_t ccSlots  = (uint8_t)((timer->notifyFallMask & ~low) | (timer->notifyRiseMask & low));
+
+    if (timer->centerAligned)
+    {
+        ccSlots |= updSlots;
+        updSlots = 0;
+    }
+    /* Kênh shifted: cả hai cạnh đều ở CCx và luôn cần CCx để nạp cạnh kế tiếp */
+    updSlots &= (uint8_t)~timer->shiftMask;
+    ccSlots |= timer->shiftMask;
+
+    uint16_t need = (uint16_t)(ccSlots << 1);
+    if (timer->spreadPercent || timer->ditherMask || updSlots) need |= TIM_IT_Update;
+
+    /* Cờ của ngắt vừa bật có thể đã chốt từ trước (UIF từ UG của TIM_TimeBaseInit và mỗi lần tràn):
+     * xóa trước khi bật để không vào ISR ngay với một cạnh giả */
+    uint16_t newBits = (uint16_t)(need & ~TIMx->DIER);
+    if (newBits) TIMx->SR = (uint16_t)~newBits;
+
+    TIMx->DIER = (uint16_t)((TIMx->DIER & ~(TIM_IT_Update | PWM_SR_CC_MASK)) | need);
+    if (need) Pwm_EnableTimerIrq(TIMx);
+}
+
+/*
+ * Chọn PSC/ARR cho tần số mong muốn: PSC nhỏ nhất để ARR lớn nhất (độ phân giải duty tốt nhất)
+ * Edge-aligned: f = clk / ((PSC + 1) x (ARR + 1))
+ * Center-aligned: f = clk / ((PSC + 1) x 2 x ARR)
+ * @return Tần số thực tế đạt được (Hz), 0 nếu tham số không hợp lệ
+ */
+static uint32_t Pwm_CalcTimeBase(uint32_t timerClockHz, uint32_t frequencyHz, uint8_t centerAligned,
+                                 uint16_t* psc, uint16_t* arr)
+{
+    if (frequencyHz == 0U || timerClockHz == 0U) return 0;
+
+    /* Số tick mỗi chu kỳ (center: mỗi nửa chu kỳ) khi PSC = 0 */
+    uint32_t ticksFreq = centerAligned ? (frequencyHz * 2U) : frequencyHz;
+    uint32_t maxPeriod = centerAligned ? 0xFFFFU : 0x10000U;
+    uint32_t cycles = timerClockHz / ticksFreq;
+    if (cycles < 2U) cycles = 2U;
+
+    /* PSC + 1 = ceil(cycles / maxPeriod) */
+    uint32_t prescaler = (cycles - 1U) / maxPeriod;
+    if (prescaler > 0xFFFFU) prescaler = 0xFFFFU;
+
+    /* Số tick làm tròn theo clock sau prescaler */
+    uint32_t period = ((timerClockHz / (prescaler + 1U)) + (ticksFreq / 2U)) / ticksFreq;
+    if (period < 2U) period = 2U;
+    if (period > maxPeriod) period = maxPeriod;
+
+    *psc = (uint16_t)prescaler;
+    *arr = (uint16_t)(centerAligned ? period : (period - 1U));
+
+    uint32_t divider = (prescaler + 1U) * period;
+    return (timerClockHz + (divider / 2U)) / divider / (centerAligned ? 2U : 1U);
+}
+
+/*
+ * Tần số PWM thực tế từ PSC/ARR hiện tại
+ */
+static uint32_t Pwm_CalcFrequency(uint32_t timerClockHz, uint16_t psc, uint16_t arr, uint8_t centerAligned)
+{
+    uint32_t ticks = centerAligned ? (2U * (uint32_t)arr) : ((uint32_t)arr + 1U);
+    uint32_t divider = ((uint32_t)psc + 1U) * ticks;
+    if (divider == 0U) return 0;
+    return (timerClockHz + (divider / 2U)) / divider;
+}
+
+/*
+ * Đổi PSC/ARR của Timer và tính lại CCR mọi kênh theo duty đang đặt
+ * ARPE và OCxPE bật nên các giá trị mới nằm ở thanh ghi shadow; UDIS chặn update
+ * event trong lúc ghi để PSC, ARR và các CCR cùng có hiệu lực ở một update event.
+ * Chu kỳ đang chạy kết thúc với ARR cũ, nên không chu kỳ nào dài hơn max(cũ, mới).
+ */
+static void Pwm_ApplyTimeBase(uint8_t t, uint16_t psc, uint16_t arr)
+{
+    Pwm_TimerDispatchType* timer = &Pwm_TimerDispatch[t];
+    TIM_TypeDef* TIMx = timer->TIMx;
+
+    TIMx->CR1 |= TIM_CR1_UDIS;
+
+    TIMx->PSC = psc;
+    TIMx->ARR = arr;
+    timer->spreadNominal = arr;
+    timer->spreadOffset = 0;
+    for (uint8_t cc = 0; cc < 4; cc++)
+    {
+        Pwm_ChannelType ch = timer->ccChannel[cc];
+
+        /* Kênh idle giữ nguyên mức idle, không áp lại duty cũ */
+        if (ch != PWM_NO_CHANNEL && !(timer->idleMask & (1U << cc)))
+        {
+            Pwm_ApplyDuty(&Pwm_CurrentConfigPtr->Channels[ch], arr, timer->duty[cc]);
+        }
+    }
+
+    TIMx->CR1 &= (uint16_t)~TIM_CR1_UDIS;
+
+    timer->frequencyHz = Pwm_CalcFrequency(timer->clockHz, psc, arr, timer->centerAligned);
+}
+
+/*
+ * Cấu hình time base cho Timer của kênh
+ * frequencyHz != 0: tự chọn PSC/ARR theo clock thực tế
+ * frequencyHz == 0: giữ cách cũ, tick 1us và ARR = defaultPeriod
+ */
+static void Pwm_InitTimeBase(const Pwm_ChannelConfigType* channelConfig, uint8_t t)
+{
+    uint8_t centerAligned = Pwm_TimerDispatch[t].centerAligned;
+    uint32_t clockHz = Pwm_GetTimerClock(channelConfig->TIMx);
+    uint16_t psc;
+    uint16_t arr;
+    uint32_t achievedHz = Pwm_CalcTimeBase(clockHz, (uint32_t)channelConfig->frequencyHz, centerAligned, &psc, &arr);
+
+    if (achievedHz == 0U)
+    {
+        psc = (uint16_t)((clockHz / 1000000U) - 1U);  /* 1us CNT dem len 1*/
+        arr = (uint16_t)channelConfig->defaultPeriod;
+        achievedHz = Pwm_CalcFrequency(clockHz, psc, arr, centerAligned);
+    }
+
+    /* Chế độ đếm theo cấu hình Timer (mặc định đếm lên, edge-aligned) */
+    const Pwm_TimerConfigType* timerCfg = Pwm_FindTimerConfig(Pwm_CurrentConfigPtr, channelConfig->TIMx);
+    uint16_t counterMode = TIM_CounterMode_Up;
+    if (timerCfg != NULL)
+    {
+        switch (timerCfg->counterMode) {
+        case PWM_COUNTER_CENTER_ALIGNED_1: counterMode = TIM_CounterMode_CenterAligned1; break;
+        case PWM_COUNTER_CENTER_ALIGNED_2: counterMode = TIM_CounterMode_CenterAligned2; break;
+        case PWM_COUNTER_CENTER_ALIGNED_3: counterMode = TIM_CounterMode_CenterAligned3; break;
+        default: break;
+        }
+    }
+
+    /* Cấu hình Timer*/
+    TIM_TimeBaseInitTypeDef tim;
+    TIM_TimeBaseStructInit(&tim);
+    tim.TIM_ClockDivision = TIM_CKD_DIV1;
+    tim.TIM_CounterMode = counterMode;
+    tim.TIM_Period = arr;
+    tim.TIM_Prescaler = psc;
+    TIM_TimeBaseInit(channelConfig->TIMx, &tim);
+
+    /* ARR preload: đổi chu kỳ runtime chỉ có hiệu lực ở update event kế tiếp */
+    TIM_ARRPreloadConfig(channelConfig->TIMx, ENABLE);
+
+    Pwm_TimerDispatch[t].clockHz = clockHz;
+    Pwm_TimerDispatch[t].frequencyHz = achievedHz;
+    Pwm_TimerDispatch[t].spreadNominal = arr;
+
+    /* Spread-spectrum: ISR update đổi ARR mỗi chu kỳ */
+    if (Pwm_TimerDispatch[t].spreadPercent)
+    {
+        TIM_ITConfig(channelConfig->TIMx, TIM_IT_Update, ENABLE);
+        Pwm_EnableTimerIrq(channelConfig->TIMx);
+    }
+}
+
+/*
+ * Khởi động đồng bộ các Timer đã cấu hình
+ * - PWM_SYNC_START: slave chờ ở chế độ Trigger (CEN = 0), master phát TRGO khi CEN = 1
+ *   -> tất cả counter bắt đầu từ 0; slave chạy trễ master vài chu kỳ clock timer
+ *      do đồng bộ hóa ngõ vào trigger (MSM không bù được vì master không có TRGI)
+ * - PWM_SYNC_RESET: slave chạy sẵn ở chế độ Reset, master phát TRGO mỗi update
+ *   -> counter slave bị reset mỗi chu kỳ master, giữ pha cố định lâu dài
+ * @return 1 nếu đã khởi động đồng bộ, 0 nếu master không hợp lệ (gọi TIM_Cmd riêng)
+ */
+static uint8_t Pwm_StartSynchronized(const Pwm_ConfigType* ConfigPtr)
+{
+    if (ConfigPtr->SyncMode == PWM_SYNC_NONE) return 0;
+    uint8_t m = Pwm_GetTimerIndex(ConfigPtr->SyncMaster);
+    if (m >= PWM_NUM_TIMERS || Pwm_TimerDispatch[m].TIMx != ConfigPtr->SyncMaster) return 0;
+
+    TIM_TypeDef* master = ConfigPtr->SyncMaster;
+    TIM_SelectOutputTrigger(master, (ConfigPtr->SyncMode == PWM_SYNC_START) ? TIM_TRGOSource_Enable
+                                                                          : TIM_TRGOSource_Update);
+
+    for (uint8_t t = 0; t < PWM_NUM_TIMERS; t++)
+    {
+        TIM_TypeDef* slave = Pwm_TimerDispatch[t].TIMx;
+        if (slave == NULL || t == m) continue;
+
+        TIM_SelectInputTrigger(slave, Pwm_ItrTable[t][m]);
+        slave->CNT = 0;
+        if (ConfigPtr->SyncMode == PWM_SYNC_START)
+        {
+            TIM_SelectSlaveMode(slave, TIM_SlaveMode_Trigger);
+        }
+        else
+        {
+            TIM_SelectSlaveMode(slave, TIM_SlaveMode_Reset);
+            TIM_Cmd(slave, ENABLE);
+        }
+    }
+
+    /* Master chạy cuối cùng: cạnh TRGO đầu tiên kéo theo toàn bộ slave */
+    master->CNT = 0;
+    TIM_Cmd(master, ENABLE);
+    return 1;
+}
+
+/*
+ * Spread-spectrum: chọn ARR cho chu kỳ kế tiếp trong khoảng danh định ±spreadPercent
+ * và tính lại CCR theo duty đang đặt. ARR/CCR có preload nên cùng áp dụng ở update kế tiếp.
+ * Gọi từ ISR update.
+ */
+static void Pwm_SpreadStep(Pwm_TimerDispatchType* timer)
+{
+    int32_t maxDelta = (int32_t)(((uint32_t)timer->spreadNominal * timer->spreadPercent) / 100U);
+    if (maxDelta == 0) return;
+
+    int32_t offset;
+    if (timer->spreadRandom)
+    {
+        /* LFSR Galois 16 bit (x^16 + x^14 + x^13 + x^11 + 1) */
+        uint16_t lfsr = timer->spreadLfsr;
+        lfsr = (uint16_t)((lfsr >> 1) ^ ((uint16_t)(-(int16_t)(lfsr & 1U)) & 0xB400U));
+        timer->spreadLfsr = lfsr;
+        offset = (int32_t)(lfsr % (uint32_t)(2 * maxDelta + 1)) - maxDelta;
+    }
+    else
+    {
+        /* Tam giác: quét hết biên độ trong khoảng 64 chu kỳ */
+        int32_t step = (maxDelta >= 16) ? (maxDelta / 16) : 1;
+        offset = timer->spreadOffset + timer->spreadDir * step;
+        if (offset >= maxDelta)  { offset = maxDelta;  timer->spreadDir = -1; }
+        if (offset <= -maxDelta) { offset = -maxDelta; timer->spreadDir = 1; }
+    }
+    timer->spreadOffset = offset;
+
+    int32_t arr = (int32_t)timer->spreadNominal + offset;
+    if (arr < 1) arr = 1;
+    if (arr > 0xFFFF) arr = 0xFFFF;
+    timer->TIMx->ARR = (uint16_t)arr;
+
+    /* Giữ nguyên duty: CCR tỉ lệ theo ARR mới (kênh idle giữ nguyên mức idle) */
+    for (uint8_t cc = 0; cc < 4; cc++)
+    {
+        if (timer->ccChannel[cc] == PWM_NO_CHANNEL || (timer->idleMask & (1U << cc))) continue;
+
+        uint32_t compareQ15 = Pwm_CalcCompareQ15((uint16_t)arr, timer->duty[cc], timer->centerAligned);
+        if (timer->ditherMask & (1U << cc))
+        {
+            timer->ditherTarget[cc] = compareQ15;
+        }
+        else
+        {
+            Pwm_WriteCompare(timer->TIMx, (Pwm_ChannelType)(cc + 1), Pwm_CompareFromQ15(compareQ15));
+        }
+    }
+}
+
 /* ===============================
  *        Function Definitions
  * =============================== */
@@ -39,29 +723,51 @@ void Pwm_Init(const Pwm_ConfigType* ConfigPtr)
     if (ConfigPtr == NULL) return;
 
     Pwm_CurrentConfigPtr = ConfigPtr;
+
+    /* Dựng bảng dispatch ngắt theo Timer */
+    Pwm_BuildDispatch(ConfigPtr);
+
+    /* Mask các Timer đã cấu hình time base (mỗi Timer chỉ cấu hình một lần) */
+    uint8_t timerInitMask = 0;
+
     for (uint8 i = 0; i < ConfigPtr->NumChannels; i++)
     {
         const Pwm_ChannelConfigType* channelConfig = &ConfigPtr->Channels[i];
+        uint8_t t = Pwm_GetTimerIndex(channelConfig->TIMx);
+        if (t >= PWM_NUM_TIMERS) continue;
 
-        /* Cấu hình Timer*/
-        TIM_TimeBaseInitTypeDef tim;
-        tim.TIM_ClockDivision = TIM_CKD_DIV1;
-        tim.TIM_CounterMode = TIM_CounterMode_Up;
-        tim.TIM_Period = channelConfig->defaultPeriod;
-        tim.TIM_Prescaler = 8 - 1;  /* 1us CNT dem len 1*/
-        //tim.TIM_Prescaler = 8000 - 1;   /* 1ms */
-        TIM_TimeBaseInit(channelConfig->TIMx, &tim);
+        /* Các kênh chung Timer dùng chung tần số: kênh đầu tiên quyết định */
+        if (!(timerInitMask & (1U << t)))
+        {
+            Pwm_InitTimeBase(channelConfig, t);
+            timerInitMask |= (uint8_t)(1U << t);
+        }
 
         /* Giá trị compare ban đầu theo duty cycle mặc định */
-        uint16_t compareValue = ((uint32_t)channelConfig->defaultPeriod * channelConfig->defaultDutyCycle) >> 15;
+        uint16_t compareValue = Pwm_CompareFromQ15(Pwm_StoreDuty(channelConfig, channelConfig->TIMx->ARR,
+                                                                 (uint16_t)channelConfig->defaultDutyCycle));
 
         /* Cấu hình PWM*/
         TIM_OCInitTypeDef oc;
+        TIM_OCStructInit(&oc);
         oc.TIM_OCMode = TIM_OCMode_PWM1;
         oc.TIM_OutputState = TIM_OutputState_Enable;
-        oc.TIM_OCPolarity = TIM_OCPolarity_High;
+        oc.TIM_OCPolarity = (channelConfig->polarity == PWM_LOW) ? TIM_OCPolarity_Low : TIM_OCPolarity_High;
         oc.TIM_Pulse       = compareValue;
 
+        /* TIM1: ngõ ra bù CHxN (CH1..CH3) và trạng thái an toàn khi Break/MOE = 0 */
+        if (channelConfig->TIMx == TIM1)
+        {
+            if (channelConfig->complementaryOutput && channelConfig->channel <= 3)
+            {
+                oc.TIM_OutputNState = TIM_OutputNState_Enable;
+                oc.TIM_OCNPolarity  = (channelConfig->polarity == PWM_LOW) ? TIM_OCNPolarity_Low : TIM_OCNPolarity_High;
+            }
+            /* idleState = PWM_LOW: cả CHx và CHxN về mức thấp (hai khóa của nửa cầu cùng tắt) */
+            oc.TIM_OCIdleState  = (channelConfig->idleState == PWM_HIGH) ? TIM_OCIdleState_Set : TIM_OCIdleState_Reset;
+            oc.TIM_OCNIdleState = (channelConfig->idleState == PWM_HIGH) ? TIM_OCNIdleState_Set : TIM_OCNIdleState_Reset;
+        }
+
        /* Channel ID PWM -> 4 CH CH1, CH2, CH3, CH4*/
         switch (channelConfig->channel) {
             case 1: TIM_OC1Init(channelConfig->TIMx, &oc); TIM_OC1PreloadConfig(channelConfig->TIMx, TIM_OCPreload_Enable); break;
@@ -71,8 +777,42 @@ void Pwm_Init(const Pwm_ConfigType* ConfigPtr)
             default: break;
         }
 
-        /* Khởi động TImer*/
-        TIM_Cmd(channelConfig->TIMx, ENABLE);
+        /* Kênh shifted: CCR ghi trực tiếp (không preload), ngắt CCx để ISR đặt cạnh kế tiếp */
+        if (Pwm_TimerDispatch[t].shiftMask & (1U << (channelConfig->channel - 1)))
+        {
+            uint8_t shift = (channelConfig->channel % 2 == 0) ? 8U : 0U;
+            volatile uint16_t* ccmr = (channelConfig->channel <= 2) ? &channelConfig->TIMx->CCMR1 : &channelConfig->TIMx->CCMR2;
+            *ccmr &= (uint16_t)~(TIM_CCMR1_OC1PE << shift);
+
+            Pwm_ApplyDuty(channelConfig, channelConfig->TIMx->ARR, (uint16_t)channelConfig->defaultDutyCycle);
+            TIM_ITConfig(channelConfig->TIMx, (uint16_t)(TIM_IT_CC1 << (channelConfig->channel - 1)), ENABLE);
+            Pwm_EnableTimerIrq(channelConfig->TIMx);
+        }
+        /* Kênh dithering: bật ngắt update để ISR phân bổ phần lẻ */
+        else if (channelConfig->ditherEnable)
+        {
+            TIM_ITConfig(channelConfig->TIMx, TIM_IT_Update, ENABLE);
+            Pwm_EnableTimerIrq(channelConfig->TIMx);
+        }
+
+        /* TIM1: cấu hình dead-time/Break và bật Main Output */
+        if (channelConfig->TIMx == TIM1)
+        {
+            Pwm_InitAdvancedTimer(ConfigPtr->AdvancedTimer);
+        }
+
+    }
+
+    /* Khởi động TImer: đồng bộ qua TRGO/ITR nếu được cấu hình, ngược lại từng Timer riêng */
+    if (!Pwm_StartSynchronized(ConfigPtr))
+    {
+        for (uint8_t t = 0; t < PWM_NUM_TIMERS; t++)
+        {
+            if (Pwm_TimerDispatch[t].TIMx != NULL)
+            {
+                TIM_Cmd(Pwm_TimerDispatch[t].TIMx, ENABLE);
+            }
+        }
     }
 
     Pwm_IsInitialized = 1;
@@ -115,9 +855,26 @@ void Pwm_DeInit(void)
             default: break;
         }
 
-        /* Dừng TIMER*/
+        /* TIM1: tắt Main Output, chân về trạng thái idle */
+        if (channelConfig->TIMx == TIM1)
+        {
+            TIM_CtrlPWMOutputs(TIM1, DISABLE);
+        }
+
+        /* Dừng TIMER, gỡ cấu hình master/slave để lần Init sau bắt đầu từ trạng thái sạch */
         TIM_Cmd(channelConfig->TIMx, DISABLE);
+        channelConfig->TIMx->SMCR &= (uint16_t)~TIM_SMCR_SMS;
+        TIM_SelectMasterSlaveMode(channelConfig->TIMx, TIM_MasterSlaveMode_Disable);
+        TIM_SelectOutputTrigger(channelConfig->TIMx, TIM_TRGOSource_Reset);
+    }
+    /* Xóa bảng dispatch để ISR không gọi callback sau khi DeInit */
+    for (uint8_t t = 0; t < PWM_NUM_TIMERS; t++)
+    {
+        Pwm_TimerDispatch[t].TIMx = NULL;
+        Pwm_TimerDispatch[t].notifyMask = 0;
+        Pwm_TimerDispatch[t].NotificationCb = NULL;
     }
+
     Pwm_IsInitialized = 0;
     Pwm_CurrentConfigPtr = NULL;
 }
@@ -137,18 +894,15 @@ void Pwm_SetDutyCycle(Pwm_ChannelType ChannelNumber, uint16 DutyCycle)
     /* Gọi struct channelConfig với ChannelNumber tương ứng*/
     const Pwm_ChannelConfigType* channelConfig = &Pwm_CurrentConfigPtr->Channels[ChannelNumber];
 
+    uint8_t t = Pwm_GetTimerIndex(channelConfig->TIMx);
+    if (t >= PWM_NUM_TIMERS) return;
+    Pwm_LeaveIdle(channelConfig, t);
+
     /* Giá trị Period (ARR)*/
     uint16_t period = channelConfig->TIMx->ARR;
 
     /* Tính ra giá trị đếm Compare từ dutycycle muốn thay đổi và ARR*/
-    uint16_t compareValue = ((uint32_t)period * DutyCycle) >> 15;
-    switch (channelConfig->channel) {
-    case 1: channelConfig->TIMx->CCR1 = compareValue; break;
-    case 2: channelConfig->TIMx->CCR2 = compareValue; break;
-    case 3: channelConfig->TIMx->CCR3 = compareValue; break;
-    case 4: channelConfig->TIMx->CCR4 = compareValue; break;
-    default: break;
-    }
+    Pwm_ApplyDuty(channelConfig, period, (uint16_t)DutyCycle);
 }
 
 /**********************************************************
@@ -170,72 +924,149 @@ void Pwm_SetPeriodAndDuty(Pwm_ChannelType ChannelNumber, Pwm_PeriodType Period,
     /* Kiểm tra xem phần cài đặt có cho phép thay đổi*/
     if (channelConfig->classType != PWM_VARIABLE_PERIOD) return;
 
-    /* Thay đổi giá trị Period*/
-    channelConfig->TIMx->ARR = Period;
+    uint8_t t = Pwm_GetTimerIndex(channelConfig->TIMx);
+    if (t >= PWM_NUM_TIMERS) return;
 
-    /* Tính ra giá trị đếm Compare từ dutycycle muốn thay đổi và ARR*/
-    uint16_t compareValue = ((uint32_t)Period * DutyCycle) >> 15;
-    switch (channelConfig->channel) {
-    case 1: channelConfig->TIMx->CCR1 = compareValue; break;
-    case 2: channelConfig->TIMx->CCR2 = compareValue; break;
-    case 3: channelConfig->TIMx->CCR3 = compareValue; break;
-    case 4: channelConfig->TIMx->CCR4 = compareValue; break;
-    default: break;
-    }
+    /* Lưu duty mới rồi đổi Period (ARR) và CCR của cả Timer ở cùng một update event */
+    Pwm_LeaveIdle(channelConfig, t);
+    Pwm_TimerDispatch[t].duty[channelConfig->channel - 1] = (uint16_t)DutyCycle;
+    Pwm_ApplyTimeBase(t, channelConfig->TIMx->PSC, (uint16_t)Period);
 }
 
 /**********************************************************
- * @brief   Đưa kênh PWM về trạng thái idle (tắt output)
+ * @brief   Đặt tần số PWM (Hz) cho Timer của kênh
+ * @details Tự chọn PSC/ARR theo clock Timer thực tế sao cho ARR lớn nhất.
+ *          Tần số áp dụng cho mọi kênh chung Timer, duty các kênh được giữ nguyên.
+ *
+ * @param[in] ChannelNumber Số thứ tự kênh PWM
+ * @param[in] FrequencyHz   Tần số mong muốn (Hz)
+ * @return    Tần số thực tế đạt được (Hz), 0 nếu không thực hiện được
  **********************************************************/
-void Pwm_SetOutputToIdle(Pwm_ChannelType ChannelNumber)
+uint32 Pwm_SetFrequency(Pwm_ChannelType ChannelNumber, uint32 FrequencyHz)
 {
-    if (!Pwm_IsInitialized || ChannelNumber >= Pwm_CurrentConfigPtr->NumChannels) return;
+    if (!Pwm_IsInitialized || ChannelNumber >= Pwm_CurrentConfigPtr->NumChannels) return 0;
 
     const Pwm_ChannelConfigType* channelConfig = &Pwm_CurrentConfigPtr->Channels[ChannelNumber];
 
-    /* Cấu hình lại Output Compare trạng thái idle*/
-    TIM_OCInitTypeDef oc;
-    TIM_OCStructInit(&oc); // Khởi tạo giá trị mặc định
+    /* Chỉ kênh PWM_VARIABLE_PERIOD được đổi chu kỳ */
+    if (channelConfig->classType != PWM_VARIABLE_PERIOD) return 0;
 
-    oc.TIM_OCMode = TIM_OCMode_PWM1;
-    oc.TIM_OutputState = TIM_OutputState_Enable;
-    oc.TIM_Pulse = 0;
+    uint8_t t = Pwm_GetTimerIndex(channelConfig->TIMx);
+    if (t >= PWM_NUM_TIMERS) return 0;
 
-    /* Trạng thái idle PWM_HIGH / PWM_LOW sang polarity của kênh PWM cần SetOutputToIdle*/
-    oc.TIM_OCPolarity = (channelConfig->idleState == PWM_HIGH) ? TIM_OCPolarity_High : TIM_OCPolarity_Low;
+    Pwm_TimerDispatchType* timer = &Pwm_TimerDispatch[t];
+    uint16_t psc;
+    uint16_t arr;
+    uint32_t achievedHz = Pwm_CalcTimeBase(timer->clockHz, (uint32_t)FrequencyHz, timer->centerAligned, &psc, &arr);
+    if (achievedHz == 0U) return 0;
 
-    switch (channelConfig->channel) {
-        case 1: TIM_OC1Init(channelConfig->TIMx, &oc); break;
-        case 2: TIM_OC2Init(channelConfig->TIMx, &oc); break;
-        case 3: TIM_OC3Init(channelConfig->TIMx, &oc); break;
-        case 4: TIM_OC4Init(channelConfig->TIMx, &oc); break;
-        default: break;
+    /* PSC, ARR và CCR mới có hiệu lực cùng lúc ở update event kế tiếp */
+    Pwm_ApplyTimeBase(t, psc, arr);
+
+    return (uint32)achievedHz;
+}
+
+/**********************************************************
+ * @brief   Đọc tần số PWM thực tế của Timer chứa kênh
+ * @param[in] ChannelNumber Số thứ tự kênh PWM
+ * @return    Tần số (Hz), 0 nếu kênh không hợp lệ
+ **********************************************************/
+uint32 Pwm_GetFrequency(Pwm_ChannelType ChannelNumber)
+{
+    if (!Pwm_IsInitialized || ChannelNumber >= Pwm_CurrentConfigPtr->NumChannels) return 0;
+
+    uint8_t t = Pwm_GetTimerIndex(Pwm_CurrentConfigPtr->Channels[ChannelNumber].TIMx);
+    if (t >= PWM_NUM_TIMERS) return 0;
+
+    return (uint32)Pwm_TimerDispatch[t].frequencyHz;
+}
+
+/**********************************************************
+ * @brief   Đưa kênh PWM về trạng thái idle (tắt output)
+ **********************************************************/
+void Pwm_SetOutputToIdle(Pwm_ChannelType ChannelNumber)
+{
+    if (!Pwm_IsInitialized || ChannelNumber >= Pwm_CurrentConfigPtr->NumChannels) return;
+
+    const Pwm_ChannelConfigType* channelConfig = &Pwm_CurrentConfigPtr->Channels[ChannelNumber];
+
+    /* Dừng dithering / shifted để ISR không ghi lại CCR */
+    uint8_t t = Pwm_GetTimerIndex(channelConfig->TIMx);
+    if (t < PWM_NUM_TIMERS)
+    {
+        Pwm_TimerDispatch[t].ditherTarget[channelConfig->channel - 1] = 0;
+        Pwm_TimerDispatch[t].shiftActive &= (uint8_t)~(1U << (channelConfig->channel - 1));
+        Pwm_TimerDispatch[t].steadyMask |= (uint8_t)(1U << (channelConfig->channel - 1));
+        Pwm_TimerDispatch[t].idleMask |= (uint8_t)(1U << (channelConfig->channel - 1));
     }
+
+    /* Ép OCxREF bằng Forced Active / Inactive, chỉ đổi OCxM:
+     * CCxP, CCxNE/CCxNP và OISx/OISxN (TIM1) giữ nguyên cấu hình của Pwm_Init.
+     * Chân = OCxREF xor CCxP -> chọn OCxREF sao cho chân về đúng idleState */
+    uint8_t ref = (uint8_t)((channelConfig->idleState == PWM_HIGH) ^ (channelConfig->polarity == PWM_LOW));
+    Pwm_SetOcMode(channelConfig->TIMx, channelConfig->channel,
+                  ref ? TIM_ForcedAction_Active : TIM_ForcedAction_InActive);
+    channelConfig->TIMx->CCER |= (uint16_t)(TIM_CCER_CC1E << ((channelConfig->channel - 1) * 4U));
 }
 
 
 /**********************************************************
- * @brief   Đọc trạng thái đầu ra hiện tại của kênh PWM, sử dụng DIO_ReadChannel()
- *          dựa vào bảng ánh xạ từ Pwm channel sang DIO channel
- * @return  PWM_HIGH nếu compare enable, ngược lại PWM_LOW
+ * @brief   Đọc trạng thái đầu ra hiện tại của kênh PWM từ chính Timer
+ * @details Mức OCxREF suy ra từ chế độ Output Compare (CCMR):
+ *          PWM1: CNT < CCRx, PWM2: CNT >= CCRx, Forced: theo chế độ,
+ *          Toggle (kênh shifted): mức hiện tại do ISR lưu. Sau đó xét CCxP.
+ *          Ngõ ra bị tắt (CCxE = 0, hoặc MOE = 0 với TIM1) trả về idleState.
+ * @return  PWM_HIGH / PWM_LOW theo mức logic trên chân
  **********************************************************/
 Pwm_OutputStateType Pwm_GetOutputState(Pwm_ChannelType ChannelNumber)
 {
     /* Kiểm tra ChannelNumber nhập vào có hợp lệ k và Pwm được khởi tạo hay chưa*/
     if (!Pwm_IsInitialized || ChannelNumber >= Pwm_CurrentConfigPtr->NumChannels)
         return PWM_LOW;
-    /* Map từ channel của Pwm sang Dio*/
-    Dio_ChannelType dioChannel = PwmToDioChannelMap[ChannelNumber];
 
-    /*Đọc mức logic điện áp*/
-    Dio_LevelType level = Dio_ReadChannel(dioChannel);
+    const Pwm_ChannelConfigType* cfg = &Pwm_CurrentConfigPtr->Channels[ChannelNumber];
+    TIM_TypeDef* TIMx = cfg->TIMx;
+    uint8_t t = Pwm_GetTimerIndex(TIMx);
+    if (t >= PWM_NUM_TIMERS || cfg->channel < 1 || cfg->channel > 4) return PWM_LOW;
+
+    uint8_t cc = (uint8_t)(cfg->channel - 1);
+    uint16_t ccer = TIMx->CCER;
+    if (!(ccer & (TIM_CCER_CC1E << (cc * 4U))) || (TIMx == TIM1 && !(TIM1->BDTR & TIM_BDTR_MOE)))
+    {
+        return cfg->idleState;
+    }
+
+    /* Chụp CNT và CCR liền nhau để so sánh nhất quán */
+    uint16_t cnt = TIMx->CNT;
+    uint16_t ccr;
+    switch (cfg->channel) {
+        case 1: ccr = TIMx->CCR1; break;
+        case 2: ccr = TIMx->CCR2; break;
+        case 3: ccr = TIMx->CCR3; break;
+        default: ccr = TIMx->CCR4; break;
+    }
+
+    uint16_t ccmr = (cc < 2) ? TIMx->CCMR1 : TIMx->CCMR2;
+    uint16_t ocMode = (uint16_t)((ccmr >> ((cc & 1U) * 8U)) & TIM_CCMR1_OC1M);
+
+    uint8_t ref;
+    switch (ocMode) {
+        case TIM_OCMode_PWM1:           ref = (cnt < ccr); break;
+        case TIM_OCMode_PWM2:           ref = (cnt >= ccr); break;
+        case TIM_ForcedAction_Active:   ref = 1; break;
+        case TIM_OCMode_Toggle:         ref = Pwm_TimerDispatch[t].shiftLevel[cc]; break;
+        default:                        ref = 0; break;
+    }
+
+    /* CCxP = 1: polarity thấp, chân đảo so với OCxREF */
+    if (ccer & (TIM_CCER_CC1P << (cc * 4U))) ref ^= 1U;
 
-    return (level == STD_HIGH) ? PWM_HIGH : PWM_LOW;
+    return ref ? PWM_HIGH : PWM_LOW;
 }
 
 /**********************************************************
  * @brief   Tắt thông báo ngắt cho kênh PWM
- * @details Nếu sử dụng callback hoặc ngắt, tắt tại đây.
+ * @details Chỉ tắt ngắt update/CCx khi không còn kênh hay chức năng nào khác cần.
  *
  * @param[in] ChannelNumber Số thứ tự kênh PWM
  **********************************************************/
@@ -243,18 +1074,24 @@ void Pwm_DisableNotification(Pwm_ChannelType ChannelNumber)
 {
     if (!Pwm_IsInitialized || ChannelNumber >= Pwm_CurrentConfigPtr->NumChannels) return;
     const Pwm_ChannelConfigType* channelConfig = &Pwm_CurrentConfigPtr->Channels[ChannelNumber];
-    switch (channelConfig->channel) {
-    case 1: TIM_ITConfig(channelConfig->TIMx, TIM_IT_CC1, DISABLE); break;
-    case 2: TIM_ITConfig(channelConfig->TIMx, TIM_IT_CC2, DISABLE); break;
-    case 3: TIM_ITConfig(channelConfig->TIMx, TIM_IT_CC3, DISABLE); break;
-    case 4: TIM_ITConfig(channelConfig->TIMx, TIM_IT_CC4, DISABLE); break;
-    default: break;
-    }
+    uint8_t t = Pwm_GetTimerIndex(channelConfig->TIMx);
+    if (t >= PWM_NUM_TIMERS) return;
+
+    uint8_t bit = (uint8_t)(1U << (channelConfig->channel - 1));
+    Pwm_TimerDispatch[t].notifyRiseMask &= (uint8_t)~bit;
+    Pwm_TimerDispatch[t].notifyFallMask &= (uint8_t)~bit;
+
+    /* Ngắt vẫn giữ nếu kênh khác / dithering / spread / shifted còn cần */
+    Pwm_UpdateTimerIrq(t);
 }
 
 /**********************************************************
  * @brief   Bật thông báo ngắt cạnh lên/xuống/cả 2 cho kênh PWM
- * @details Nếu sử dụng callback hoặc ngắt, bật tại đây.
+ * @details Cạnh được tính trên chân ra (đã xét polarity) của Timer mà kênh dùng:
+ *          edge-aligned dùng ngắt update và CCx, center-aligned/shifted dùng CCx.
+ *          Kênh ở 0% / 100% / idle không có cạnh nên không gọi callback.
+ *          Center-aligned mode 1/2 chỉ báo cờ CCx theo một chiều đếm nên chỉ có một
+ *          cạnh: yêu cầu cạnh còn lại bị bỏ qua, PWM_BOTH_EDGES chỉ giữ cạnh có được.
  *
  * @param[in] ChannelNumber Số thứ tự kênh PWM
  * @param[in] Notification  Loại cạnh cần thông báo
@@ -264,86 +1101,178 @@ void Pwm_EnableNotification(Pwm_ChannelType ChannelNumber, Pwm_EdgeNotificationT
     if (!Pwm_IsInitialized || ChannelNumber >= Pwm_CurrentConfigPtr->NumChannels) return;
     const Pwm_ChannelConfigType* cfg = &Pwm_CurrentConfigPtr->Channels[ChannelNumber];
 
-    //cfg->notificationEnable = 1;  // Đã cài đặt khi khởi tạo
+    /* Kênh không cấu hình notification hoặc không có callback */
+    if (!cfg->notificationEnable || Pwm_CurrentConfigPtr->NotificationCb == NULL) return;
 
-    TIM_TypeDef* TIMx = cfg->TIMx;
+    uint8_t t = Pwm_GetTimerIndex(cfg->TIMx);
+    if (t >= PWM_NUM_TIMERS) return;
 
-    /* Flag cho channel tương ứng*/
-    uint16_t cc_flag = TIM_IT_CC1 << (cfg->channel - 1);  
+    uint8_t bit = (uint8_t)(1U << (cfg->channel - 1));
+    Pwm_TimerDispatchType* timer = &Pwm_TimerDispatch[t];
 
-    /* Cấu hình ngắt cạnh theo yêu cầu*/
-    // if (Notification & PWM_RISING_EDGE)
-    //     TIM_ITConfig(TIMx, cc_flag, ENABLE);
-    // if (Notification & PWM_FALLING_EDGE)
-    // TIM_ITConfig(TIMx, TIM_IT_Update, ENABLE);
+    uint8_t wantRise = (Notification == PWM_RISING_EDGE || Notification == PWM_BOTH_EDGES);
+    uint8_t wantFall = (Notification == PWM_FALLING_EDGE || Notification == PWM_BOTH_EDGES);
 
-    TIM_ITConfig(TIM2, TIM_IT_Update, ENABLE);
+    /* Center-aligned 1: chỉ cạnh lên OCxREF, mode 2: chỉ cạnh xuống (polarity thấp đảo cạnh trên chân).
+     * Kênh shifted chạy Toggle nên vẫn có cả hai cạnh */
+    if (!(timer->shiftMask & bit) &&
+        (timer->counterMode == PWM_COUNTER_CENTER_ALIGNED_1 || timer->counterMode == PWM_COUNTER_CENTER_ALIGNED_2))
+    {
+        uint8_t refRise = (timer->counterMode == PWM_COUNTER_CENTER_ALIGNED_1);
+        uint8_t pinRise = (uint8_t)(refRise ^ ((timer->lowPolarityMask & bit) != 0));
+        if (pinRise) wantFall = 0;
+        else wantRise = 0;
 
-    /* Xác định IRQn tương ứng để bật NVIC*/ 
-    IRQn_Type irq = (TIMx == TIM2) ? TIM2_IRQn :
-                    (TIMx == TIM3) ? TIM3_IRQn :
-                    (TIMx == TIM4) ? TIM4_IRQn : (IRQn_Type)0xFF;
+        /* Cạnh yêu cầu không bao giờ xảy ra: giữ nguyên cấu hình cũ, không bật ngắt thừa */
+        if (!wantRise && !wantFall) return;
+    }
 
-    /* Cấu hình NVIC cho ngắt Timer*/
-    if (irq != (IRQn_Type)0xFF)
-    {
-        NVIC_InitTypeDef nvic;
-        nvic.NVIC_IRQChannel = (uint8_t)irq;
-        nvic.NVIC_IRQChannelPreemptionPriority = 0;
-        nvic.NVIC_IRQChannelSubPriority = 0;
-        nvic.NVIC_IRQChannelCmd = ENABLE;
-        NVIC_Init(&nvic);
-    }   
+    /* Cạnh mới thay thế cạnh đã chọn trước đó */
+    if (wantRise) timer->notifyRiseMask |= bit;
+    else timer->notifyRiseMask &= (uint8_t)~bit;
+
+    if (wantFall) timer->notifyFallMask |= bit;
+    else timer->notifyFallMask &= (uint8_t)~bit;
+
+    Pwm_UpdateTimerIrq(t);
 }
 
 /**********************************************************
  * @brief   Hàm xử lý ngắt chung cho tất cả các TIMx, được gọi từ TIMx_IRQHandler
+ * @details Đọc SR một lần, xóa các cờ đang bật ngắt, sau đó chỉ gọi callback
+ *          của các kênh có cờ tương ứng dựa vào bảng dispatch của Timer.
+ *          Thời gian xử lý không phụ thuộc số kênh được cấu hình.
  * @param   TIMx  Địa chỉ timer xảy ra ngắt
  **********************************************************/
 void Pwm_IsrHandler(TIM_TypeDef *TIMx)
 {
-    for (uint8_t i = 0; i < IoHwAb0_PwmCfg.NumChannels; i++)
-    {
-        /* Trỏ đến cấu hình từng channel để xử lý*/
-        const Pwm_ChannelConfigType* cfg = &IoHwAb0_PwmCfg.Channels[i];
+    uint8_t t = Pwm_GetTimerIndex(TIMx);
+    if (t >= PWM_NUM_TIMERS) return;
 
-        /* Kiểm tra có thuộc ngắt của Timer truyền vào ko, lọc bớt các channel của Timer khác*/
-        if (cfg->TIMx != TIMx) continue;
+    /* Đọc SR một lần, chỉ giữ các cờ đang được bật ngắt trong DIER */
+    uint16_t pending = TIMx->SR & TIMx->DIER;
 
-        boolean triggered = FALSE;
+    /* Xóa đúng các cờ vừa đọc (SR là rc_w0, ghi 1 vào các bit khác không ảnh hưởng) */
+    TIMx->SR = (uint16_t)~pending;
 
-        /* Chỉ xử lý từ CH1 -> CH4*/
-        if (cfg->channel >= 1 && cfg->channel <= 4)
-        {
-            /* Tạo mask
-             * CH1 → TIM_IT_CC1
-             * CH2 → TIM_IT_CC2
-             * CH3 → TIM_IT_CC3
-             * CH4 → TIM_IT_CC4
-             */
-            uint16_t cc_flag = TIM_IT_CC1 << (cfg->channel - 1);
-
-            /* Xóa cờ ngắt Capture compare*/
-            if (TIM_GetITStatus(TIMx, cc_flag) != RESET)
-            {
-                TIM_ClearITPendingBit(TIMx, cc_flag);
-                triggered = TRUE;
-            }
-        }
-        
-        /* Xóa cờ ngắt Pending*/
-        if (TIM_GetITStatus(TIMx, TIM_IT_Update) != RESET)
-        {
-            TIM_ClearITPendingBit(TIMx, TIM_IT_Update);
-            triggered = TRUE;
-        }
+    Pwm_TimerDispatchType* disp = &Pwm_TimerDispatch[t];
+
+    /* Dithering: mỗi chu kỳ cộng phần lẻ vào bộ tích lũy, tràn thì CCR + 1 cho chu kỳ kế tiếp */
+    /* Spread-spectrum chạy trước để dithering dùng giá trị compare theo ARR mới.
+     * Center-aligned có update ở cả đỉnh lẫn đáy: chỉ đổi ARR sau update ở đỉnh (DIR = 1),
+     * preload nạp ở đáy nên hai nửa lên/xuống của chu kỳ sau dùng cùng một ARR */
+    if ((pending & TIM_IT_Update) && disp->spreadPercent &&
+        (!disp->centerAligned || (TIMx->CR1 & TIM_CR1_DIR)))
+    {
+        Pwm_SpreadStep(disp);
+    }
 
-        /* Gọi callback nếu có ngắt xảy ra và chân đó có enable ngắt*/
-        if (triggered && cfg->notificationEnable && IoHwAb0_PwmCfg.NotificationCb)
+    if ((pending & TIM_IT_Update) && disp->ditherMask)
+    {
+        uint8_t dither = disp->ditherMask;
+        while (dither)
         {
-            IoHwAb0_PwmCfg.NotificationCb(cfg->channel);  
+            uint8_t cc = (uint8_t)__builtin_ctz(dither);
+            dither &= (uint8_t)(dither - 1U);
+
+            uint32_t target = disp->ditherTarget[cc];
+            uint32_t acc = (uint32_t)disp->ditherAcc[cc] + (target & 0x7FFFU);
+            disp->ditherAcc[cc] = (uint16_t)(acc & 0x7FFFU);
+
+            /* CCR có preload, giá trị mới áp dụng từ chu kỳ sau */
+            Pwm_WriteCompare(TIMx, (Pwm_ChannelType)(cc + 1), Pwm_CompareFromQ15(target + (acc & 0x8000U)));
         }
     }
+
+    /* Kênh shifted: vừa có cạnh ở CCx, nạp CCR cho cạnh kế tiếp */
+    uint8_t shiftedEvents = (uint8_t)((pending & PWM_SR_CC_MASK) >> 1) & disp->shiftActive;
+    uint8_t shiftedRise = 0;
+    uint8_t shifted = shiftedEvents;
+    while (shifted)
+    {
+        uint8_t cc = (uint8_t)__builtin_ctz(shifted);
+        shifted &= (uint8_t)(shifted - 1U);
+
+        uint32_t edges = disp->shiftEdges[cc];
+        disp->shiftLevel[cc] ^= 1U;
+        shiftedRise |= (uint8_t)(disp->shiftLevel[cc] << cc);
+        Pwm_WriteCompare(TIMx, (Pwm_ChannelType)(cc + 1),
+                         (uint16_t)(disp->shiftLevel[cc] ? (edges >> 16) : (edges & 0xFFFFU)));
+    }
+
+    if (disp->NotificationCb == NULL) return;
+
+    /* Cạnh của OCxREF (polarity cao):
+     * - Edge-aligned: update = cạnh lên, CCx = cạnh xuống
+     * - Center-aligned 1: cờ CCx chỉ khi đếm xuống -> luôn là cạnh lên
+     * - Center-aligned 2: cờ CCx chỉ khi đếm lên -> luôn là cạnh xuống
+     * - Center-aligned 3: mức OCxREF hiện tại (PWM1: CNT < CCRx) cho biết cạnh vừa qua.
+     *   Không đọc DIR vì counter có thể đã đổi chiều ở 0/ARR trước khi ISR chạy. Còn sai
+     *   nếu độ trễ ISR lớn hơn khoảng giữa hai lần match (duty rất nhỏ / rất lớn): khi đó
+     *   counter đã qua CCRx lần nữa và cạnh được báo theo lần match sau.
+     * - Shifted: CCx, mức sau toggle cho biết cạnh lên/xuống */
+    uint8_t ccEvents = (uint8_t)((pending & PWM_SR_CC_MASK) >> 1);
+    uint8_t rise, fall;
+    if (disp->counterMode == PWM_COUNTER_CENTER_ALIGNED_1)
+    {
+        rise = ccEvents;
+        fall = 0;
+    }
+    else if (disp->counterMode == PWM_COUNTER_CENTER_ALIGNED_2)
+    {
+        rise = 0;
+        fall = ccEvents;
+    }
+    else if (disp->counterMode == PWM_COUNTER_CENTER_ALIGNED_3)
+    {
+        uint16_t cnt = TIMx->CNT;
+        rise = 0;
+        if ((ccEvents & 0x01U) && cnt < TIMx->CCR1) rise |= 0x01U;
+        if ((ccEvents & 0x02U) && cnt < TIMx->CCR2) rise |= 0x02U;
+        if ((ccEvents & 0x04U) && cnt < TIMx->CCR3) rise |= 0x04U;
+        if ((ccEvents & 0x08U) && cnt < TIMx->CCR4) rise |= 0x08U;
+        fall = (uint8_t)(ccEvents & ~rise);
+    }
+    else
+    {
+        rise = (pending & TIM_IT_Update) ? 0x0F : 0;
+        fall = ccEvents;
+    }
+    rise = (uint8_t)((rise & ~disp->shiftMask) | shiftedRise);
+    fall = (uint8_t)((fall & ~disp->shiftMask) | (shiftedEvents & ~shiftedRise));
+
+    /* Polarity thấp đảo mức chân so với OCxREF */
+    uint8_t low = disp->lowPolarityMask;
+    uint8_t pinRise = (uint8_t)((rise & ~low) | (fall & low));
+    uint8_t pinFall = (uint8_t)((fall & ~low) | (rise & low));
+
+    uint8_t slots = (uint8_t)((pinRise & disp->notifyRiseMask) | (pinFall & disp->notifyFallMask));
+    slots &= (uint8_t)(disp->notifyMask & ~disp->steadyMask);
+
+    while (slots)
+    {
+        uint8_t cc = (uint8_t)__builtin_ctz(slots);
+        slots &= (uint8_t)(slots - 1U);
+        disp->NotificationCb(disp->ccChannel[cc]);
+    }
+}
+
+/**********************************************************
+ * @brief   Bật lại ngõ ra TIM1 (MOE) sau sự kiện Break
+ * @details Khi Break xảy ra, phần cứng xóa MOE ngay lập tức. Hàm này xóa cờ Break
+ *          và bật lại MOE; nếu BKIN vẫn tích cực thì MOE bị phần cứng giữ ở 0.
+ *
+ * @return  E_OK nếu đã bật lại, E_NOT_OK nếu Break vẫn còn tích cực
+ **********************************************************/
+Std_ReturnType Pwm_ClearBreak(void)
+{
+    if (!Pwm_IsInitialized) return E_NOT_OK;
+    if (Pwm_TimerDispatch[Pwm_GetTimerIndex(TIM1)].TIMx != TIM1) return E_NOT_OK;
+
+    TIM_ClearFlag(TIM1, TIM_FLAG_Break);
+    TIM_CtrlPWMOutputs(TIM1, ENABLE);
+
+    return (TIM1->BDTR & TIM_BDTR_MOE) ? E_OK : E_NOT_OK;
 }
 
 /**********************************************************
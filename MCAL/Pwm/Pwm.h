@@ -16,7 +16,7 @@
 #include "Std_Types.h"          /* Các kiểu dữ liệu chuẩn AUTOSAR */
 #include "stm32f10x_tim.h"      /* Thư viện SPL: Timer PWM cho STM32F103 */
 #include "misc.h"  // NVIC_InitTypeDef
-#include "Dio.h"
+#include <stddef.h>   // Cung cấp định nghĩa NULL
 
 /* Define sử dụng 12 chân phần cứng PWM (TIM2, TIM3, TIM4) STM32F1
  * TIM2_CH1	PA0	TIM2_CH1	
@@ -31,6 +31,13 @@
  * TIM4_CH2	PB7	TIM4_CH2	
  * TIM4_CH3	PB8	TIM4_CH3	
  * TIM4_CH4	PB9	TIM4_CH4
+ *
+ * TIM1 (Advanced Timer, có ngõ ra bù CHxN, dead-time và Break input BKIN)
+ * TIM1_CH1	PA8	TIM1_CH1N	PB13
+ * TIM1_CH2	PA9	TIM1_CH2N	PB14
+ * TIM1_CH3	PA10	TIM1_CH3N	PB15
+ * TIM1_CH4	PA11	(không có CH4N)
+ * TIM1_BKIN	PB12
  */
 #define PWM_CHANNEL_TIM2_CH1   ((Pwm_ChannelType)0)
 #define PWM_CHANNEL_TIM2_CH2   ((Pwm_ChannelType)1)
@@ -47,6 +54,14 @@
 #define PWM_CHANNEL_TIM4_CH3   ((Pwm_ChannelType)10)
 #define PWM_CHANNEL_TIM4_CH4   ((Pwm_ChannelType)11)
 
+#define PWM_CHANNEL_TIM1_CH1   ((Pwm_ChannelType)12)
+#define PWM_CHANNEL_TIM1_CH2   ((Pwm_ChannelType)13)
+#define PWM_CHANNEL_TIM1_CH3   ((Pwm_ChannelType)14)
+#define PWM_CHANNEL_TIM1_CH4   ((Pwm_ChannelType)15)
+
+/* Số Timer PWM driver quản lý ngắt (TIM2, TIM3, TIM4, TIM1) */
+#define PWM_NUM_TIMERS         4U
+
 /**********************************************************
  * Định nghĩa các kiểu dữ liệu của PWM Driver
  **********************************************************/
@@ -90,9 +105,23 @@ typedef enum {
 typedef enum {
     PWM_VARIABLE_PERIOD      = 0x00,   /**< PWM period thay đổi được */
     PWM_FIXED_PERIOD         = 0x01,   /**< PWM period cố định */
-    PWM_FIXED_PERIOD_SHIFTED = 0x02    /**< PWM period cố định, shifted */
+    PWM_FIXED_PERIOD_SHIFTED = 0x02    /**< PWM period cố định, cạnh lên lệch pha theo phaseShift */
 } Pwm_ChannelClassType;
 
+/**********************************************************
+ * @enum    Pwm_CounterModeType
+ * @brief   Chế độ đếm của Timer PWM
+ * @details Center-aligned: đếm lên tới ARR rồi đếm xuống, chu kỳ = 2 x ARR tick,
+ *          xung đối xứng quanh đỉnh chu kỳ. Mode 1/2/3 chọn thời điểm cờ CCx
+ *          (đếm xuống / đếm lên / cả hai), thuận tiện lấy mẫu ADC giữa xung.
+ **********************************************************/
+typedef enum {
+    PWM_COUNTER_EDGE_ALIGNED     = 0x00,   /**< Đếm lên (mặc định) */
+    PWM_COUNTER_CENTER_ALIGNED_1 = 0x01,   /**< Center-aligned, cờ CCx khi đếm xuống */
+    PWM_COUNTER_CENTER_ALIGNED_2 = 0x02,   /**< Center-aligned, cờ CCx khi đếm lên */
+    PWM_COUNTER_CENTER_ALIGNED_3 = 0x03    /**< Center-aligned, cờ CCx cả hai chiều */
+} Pwm_CounterModeType;
+
 /**********************************************************
  * @struct  Pwm_ChannelConfigType
  * @brief   Cấu trúc cấu hình cho từng kênh PWM
@@ -101,13 +130,60 @@ typedef struct {
     TIM_TypeDef*              TIMx;             /**< Timer sử dụng (TIM1, TIM2, ...) */
     Pwm_ChannelType           channel;          /**< Channel số (1, 2, 3, 4 tương ứng CH1, CH2, CH3, CH4) */
     Pwm_ChannelClassType      classType;        /**< Loại kênh */
-    Pwm_PeriodType            defaultPeriod;    /**< Chu kỳ mặc định */
+    Pwm_PeriodType            defaultPeriod;    /**< Chu kỳ mặc định (ARR, tick 1us), chỉ dùng khi frequencyHz = 0 */
+    uint32                    frequencyHz;      /**< Tần số PWM (Hz), driver tự chọn PSC/ARR theo clock Timer */
     uint16                    defaultDutyCycle; /**< Duty Cycle mặc định (0x0000 - 0x8000) */
     Pwm_OutputStateType       polarity;         /**< Đầu ra ban đầu */
     Pwm_OutputStateType       idleState;        /**< Trạng thái khi idle */
     uint8                   notificationEnable; /**< Cho phép ngắt ở chân Pwm hay không */
+    uint8                     ditherEnable;     /**< 1 = dithering sigma-delta, phân bổ phần lẻ duty qua nhiều chu kỳ */
+    uint8                     complementaryOutput; /**< 1 = bật ngõ ra bù CHxN (chỉ TIM1 CH1..CH3) */
+    uint16                    phaseShift;       /**< PWM_FIXED_PERIOD_SHIFTED: lệch pha cạnh lên (0x0000 - 0x8000 của chu kỳ) */
 } Pwm_ChannelConfigType;
 
+/**********************************************************
+ * @struct  Pwm_AdvancedTimerConfigType
+ * @brief   Cấu hình riêng cho Advanced Timer TIM1 (thanh ghi BDTR)
+ * @details Khi có Break, phần cứng xóa MOE và đưa CHx/CHxN về trạng thái
+ *          idleState của kênh mà không cần phần mềm can thiệp.
+ **********************************************************/
+typedef struct {
+    uint16                    deadTimeNs;       /**< Dead-time giữa CHx và CHxN (ns), làm tròn lên theo bước DTG */
+    uint8                     breakEnable;      /**< 1 = bật Break input BKIN (PB12) */
+    Pwm_OutputStateType       breakPolarity;    /**< Mức tích cực của BKIN: PWM_HIGH / PWM_LOW */
+    uint8                     automaticOutput;  /**< 1 = tự bật lại MOE ở update event sau khi hết Break */
+} Pwm_AdvancedTimerConfigType;
+
+/**********************************************************
+ * @enum    Pwm_SpreadProfileType
+ * @brief   Dạng dao động ARR của chế độ spread-spectrum
+ **********************************************************/
+typedef enum {
+    PWM_SPREAD_TRIANGLE = 0x00,   /**< ARR quét tam giác trong ±spreadPercent */
+    PWM_SPREAD_RANDOM   = 0x01    /**< ARR giả ngẫu nhiên (LFSR) trong ±spreadPercent */
+} Pwm_SpreadProfileType;
+
+/**********************************************************
+ * @struct  Pwm_TimerConfigType
+ * @brief   Cấu hình riêng cho từng Timer (Timer không có trong danh sách dùng mặc định)
+ **********************************************************/
+typedef struct {
+    TIM_TypeDef*              TIMx;             /**< Timer áp dụng */
+    Pwm_CounterModeType       counterMode;      /**< Edge-aligned hoặc center-aligned 1/2/3 */
+    uint8                     spreadPercent;    /**< Spread-spectrum: ARR dao động ±% mỗi chu kỳ (0 = tắt, tối đa 50) */
+    Pwm_SpreadProfileType     spreadProfile;    /**< Dạng dao động: tam giác / ngẫu nhiên */
+} Pwm_TimerConfigType;
+
+/**********************************************************
+ * @enum    Pwm_SyncModeType
+ * @brief   Đồng bộ các Timer PWM qua TRGO (master) / ITR (slave)
+ **********************************************************/
+typedef enum {
+    PWM_SYNC_NONE  = 0x00,   /**< Mỗi Timer tự khởi động (TIM_Cmd riêng) */
+    PWM_SYNC_START = 0x01,   /**< Slave ở chế độ Trigger: CEN của master kéo tất cả chạy (slave trễ vài clock timer) */
+    PWM_SYNC_RESET = 0x02    /**< Slave ở chế độ Reset: mỗi update của master reset counter của slave */
+} Pwm_SyncModeType;
+
 /**********************************************************
  * @struct  Pwm_ConfigType
  * @brief   Cấu trúc cấu hình tổng thể cho driver PWM
@@ -115,7 +191,12 @@ typedef struct {
 typedef struct {
     const Pwm_ChannelConfigType* Channels;    /**< Danh sách các cấu hình kênh */
     uint8                        NumChannels; /**< Số lượng kênh PWM */
-    void (*NotificationCb)(uint8);            /* Callback chung, tham số truyền vào ID của channel*/
+    void (*NotificationCb)(uint8);            /* Callback chung, tham số truyền vào ID của channel (index trong Channels)*/
+    const Pwm_AdvancedTimerConfigType* AdvancedTimer; /**< Cấu hình TIM1 (NULL: không dead-time, không Break) */
+    const Pwm_TimerConfigType*   Timers;      /**< Cấu hình riêng từng Timer (NULL: tất cả edge-aligned) */
+    uint8                        NumTimers;   /**< Số phần tử trong Timers */
+    Pwm_SyncModeType             SyncMode;    /**< Đồng bộ khởi động/reset giữa các Timer đang dùng */
+    TIM_TypeDef*                 SyncMaster;  /**< Timer master phát TRGO (phải có kênh trong Channels) */
 } Pwm_ConfigType;
 
 /**********************************************************
@@ -142,12 +223,29 @@ void Pwm_SetDutyCycle(Pwm_ChannelType ChannelNumber, uint16 DutyCycle);
 
 /**********************************************************
  * @brief   Đặt period và duty cycle cho kênh PWM (nếu hỗ trợ)
+ * @details Period và duty có hiệu lực cùng lúc ở update event kế tiếp (ARR/CCR preload),
+ *          các kênh khác cùng Timer giữ nguyên duty.
  * @param   ChannelNumber: Số thứ tự kênh PWM
  * @param   Period: Chu kỳ PWM (tính bằng tick timer)
  * @param   DutyCycle: Duty cycle (0x0000 - 0x8000)
  **********************************************************/
 void Pwm_SetPeriodAndDuty(Pwm_ChannelType ChannelNumber, Pwm_PeriodType Period, uint16 DutyCycle);
 
+/**********************************************************
+ * @brief   Đặt tần số PWM (Hz) cho Timer của kênh, PSC/ARR tự chọn để ARR lớn nhất
+ * @param   ChannelNumber: Số thứ tự kênh PWM
+ * @param   FrequencyHz: Tần số mong muốn (Hz)
+ * @return  Tần số thực tế đạt được (Hz), 0 nếu lỗi
+ **********************************************************/
+uint32 Pwm_SetFrequency(Pwm_ChannelType ChannelNumber, uint32 FrequencyHz);
+
+/**********************************************************
+ * @brief   Đọc tần số PWM thực tế của kênh
+ * @param   ChannelNumber: Số thứ tự kênh PWM
+ * @return  Tần số (Hz), 0 nếu kênh không hợp lệ
+ **********************************************************/
+uint32 Pwm_GetFrequency(Pwm_ChannelType ChannelNumber);
+
 /**********************************************************
  * @brief   Đưa kênh PWM về trạng thái idle
  * @param   ChannelNumber: Số thứ tự kênh PWM
@@ -169,6 +267,8 @@ void Pwm_DisableNotification(Pwm_ChannelType ChannelNumber);
 
 /**********************************************************
  * @brief   Bật thông báo ngắt cạnh lên/xuống/cả 2 cho kênh PWM
+ * @details Timer center-aligned mode 1 chỉ có cạnh lên OCxREF, mode 2 chỉ có cạnh xuống
+ *          (polarity thấp thì ngược lại trên chân): cạnh không có bị bỏ qua
  * @param   ChannelNumber: Số thứ tự kênh PWM
  * @param   Notification:  Loại cạnh cần thông báo
  **********************************************************/
@@ -180,7 +280,17 @@ void Pwm_EnableNotification(Pwm_ChannelType ChannelNumber, Pwm_EdgeNotificationT
  **********************************************************/
 void Pwm_GetVersionInfo(Std_VersionInfoType* versioninfo);
 
+/**********************************************************
+ * @brief   Bật lại ngõ ra TIM1 (MOE) sau sự kiện Break
+ * @return  E_OK nếu đã bật lại, E_NOT_OK nếu Break vẫn còn tích cực
+ **********************************************************/
+Std_ReturnType Pwm_ClearBreak(void);
+
+void TIM1_UP_IRQHandler(void);
+void TIM1_CC_IRQHandler(void);
 void TIM2_IRQHandler(void);
+void TIM3_IRQHandler(void);
+void TIM4_IRQHandler(void);
 
 void Pwm_IsrHandler(TIM_TypeDef* TIMx);
 